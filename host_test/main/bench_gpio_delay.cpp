@@ -0,0 +1,37 @@
+#include <cstdio>
+#include "unity.h"
+#include "GpioDelay.hpp"
+#include "GpioLatency.hpp"
+#include "host_test.hpp"
+
+using namespace Components;
+
+namespace
+{
+    constexpr size_t ITERATIONS = 2000;
+    constexpr uint32_t DELAYS_NS[] = {250, 1000, 4700, 10000, 60000};
+
+    /*
+     * Runs in real time, so the errors include the scheduling noise of the host. On the chip, the same
+     * measureAccuracy() call reports the error of the cycle counter based wait.
+     */
+    void benchmarkDelayAccuracy()
+    {
+        GpioDelay::calibrate();
+        printf("cycles/us %u, overhead %u cycles\n", GpioDelay::cyclesPerUs(), GpioDelay::overheadCycles());
+        printf("  delay ns  error p50 ns  error p99 ns  error p99.9 ns\n");
+        for (uint32_t ns : DELAYS_NS)
+        {
+            LatencyHistogram errors;
+            GpioDelay::measureAccuracy(ns, ITERATIONS, errors);
+            printf("%10u  %12u  %12u  %14u\n", ns, errors.percentile(50), errors.percentile(99), errors.percentile(99.9f));
+
+            TEST_ASSERT_EQUAL_UINT32(ITERATIONS, errors.count());
+        }
+    }
+}
+
+void runGpioDelayBenchmarks()
+{
+    RUN_TEST(benchmarkDelayAccuracy);
+}
@@ -0,0 +1,155 @@
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include "unity.h"
+#include "Gpio.hpp"
+#include "GpioMask.hpp"
+#include "PinSet.hpp"
+#include "host_test.hpp"
+
+using namespace Components;
+
+namespace
+{
+    constexpr size_t PASSES = 20000;
+    constexpr size_t ROUNDS = 5;
+
+    /*
+     * Stand-in for one object per pin where there are more pins than native GPIOs, laid out like PinOutput.
+     */
+    struct PinObject
+    {
+        uint32_t num;
+    };
+
+    static_assert(sizeof(PinObject) == sizeof(PinOutput), "PinObject has to cost what a PinOutput costs");
+
+    /*
+     * The first N valid pins, as handles in \c set and as \c PinOutput objects in \c pins.
+     */
+    template <size_t N>
+    void addPins(PinSet<N> &set, std::deque<PinOutput> &pins)
+    {
+        for (uint32_t pin : GpioMask::valid())
+        {
+            if (set.size() == N)
+            {
+                break;
+            }
+            set.add(PinHandle(GPIONum(pin)), PinSetMode::OUTPUT);
+            pins.emplace_back(GPIONum(pin));
+        }
+    }
+
+    /*
+     * N expander pins of backends 1 to 3, as handles in \c set and as objects in \c pins.
+     */
+    template <size_t N>
+    void addExpanderPins(PinSet<N> &set, std::deque<PinObject> &pins)
+    {
+        for (uint8_t backend = 1; backend < PinHandle::MAX_BACKENDS && set.size() < N; backend++)
+        {
+            for (uint8_t index = 0; index <= PinHandle::MAX_INDEX && set.size() < N; index++)
+            {
+                set.add(PinHandle::fromBackend(backend, index), PinSetMode::OUTPUT);
+                pins.push_back(PinObject{index});
+            }
+        }
+    }
+
+    /*
+     * The fastest of ROUNDS rounds, so a preempted round doesn't count.
+     */
+    template <typename Fn>
+    double nsPerPin(size_t pin_count, Fn &&pass)
+    {
+        double best = 0;
+        for (size_t round = 0; round < ROUNDS; round++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < PASSES; i++)
+            {
+                pass();
+            }
+            std::chrono::duration<double, std::nano> taken = std::chrono::steady_clock::now() - start;
+            double ns = taken.count() / (PASSES * pin_count);
+            best = round == 0 || ns < best ? ns : best;
+        }
+        return best;
+    }
+
+    /*
+     * Walks \c set and \c objects, \c value returns the pin number of an object.
+     */
+    template <size_t N, typename Object, typename Value>
+    void compare(const char *name, const PinSet<N> &set, const std::deque<Object> &objects, Value &&value)
+    {
+        TEST_ASSERT_EQUAL_UINT32(N, set.size());
+        TEST_ASSERT_EQUAL_UINT32(N, objects.size());
+
+        // both walks sum up the pin numbers, so the compiler can't drop them
+        volatile uint32_t sink = 0;
+        double set_ns = nsPerPin(N, [&] {
+            uint32_t sum = 0;
+            set.forEach([&](PinHandle handle, PinSetConfig config) {
+                sum += config.mode == static_cast<uint8_t>(PinSetMode::OUTPUT) ? handle.getIndex() : 0;
+            });
+            sink = sink + sum;
+        });
+        double objects_ns = nsPerPin(N, [&] {
+            uint32_t sum = 0;
+            for (const Object &object : objects)
+            {
+                sum += value(object);
+            }
+            sink = sink + sum;
+        });
+
+        // what either takes on the stack when declared locally
+        size_t set_bytes = sizeof(PinSet<N>);
+        size_t objects_bytes = sizeof(Object) * N;
+        printf("%3zu pins  PinSet %4zu bytes %6.2f ns/pin  %s %4zu bytes %6.2f ns/pin\n",
+               N, set_bytes, set_ns, name, objects_bytes, objects_ns);
+
+        // two bytes per pin plus the fixed size of the base
+        TEST_ASSERT_EQUAL_UINT32(sizeof(PinSetBase) + 2 * N, set_bytes);
+    }
+
+    template <size_t N>
+    void benchmarkPins()
+    {
+        PinSet<N> set;
+        std::deque<PinOutput> pins;
+        addPins(set, pins);
+        compare("PinOutput[]", set, pins, [](const PinOutput &pin) { return pin.getNum().get_value<uint32_t>(); });
+    }
+
+    /*
+     * More pins than any chip has, as on a board with several expanders.
+     */
+    template <size_t N>
+    void benchmarkExpanderPins()
+    {
+        PinSet<N> set;
+        std::deque<PinObject> pins;
+        addExpanderPins(set, pins);
+        compare("objects[]  ", set, pins, [](const PinObject &pin) { return pin.num; });
+    }
+
+    void benchmarkPinSetAgainstPinOutputs()
+    {
+        printf("sizeof(PinHandle) %zu, sizeof(PinSetConfig) %zu, sizeof(PinOutput) %zu, sizeof(PinSetBase) %zu\n",
+               sizeof(PinHandle), sizeof(PinSetConfig), sizeof(PinOutput), sizeof(PinSetBase));
+        benchmarkPins<8>();
+        benchmarkPins<16>();
+        benchmarkPins<32>();
+        benchmarkExpanderPins<64>();
+        benchmarkExpanderPins<128>();
+        benchmarkExpanderPins<192>();
+    }
+}
+
+void runPinSetBenchmarks()
+{
+    RUN_TEST(benchmarkPinSetAgainstPinOutputs);
+}
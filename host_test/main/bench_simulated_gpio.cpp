@@ -0,0 +1,75 @@
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include "unity.h"
+#include "GpioBanks.hpp"
+#include "SimulatedGpio.hpp"
+#include "host_test.hpp"
+
+using namespace Components;
+
+namespace
+{
+    constexpr size_t MAX_THREADS = 8;
+    constexpr uint32_t PINS_PER_THREAD = 2;
+    constexpr uint32_t TOGGLES = 200000;
+
+    /*
+     * Thread t toggles GPIO 2t and 2t + 1 of bank 0 and checks after every store that its own pins read back
+     * what it wrote. A store of another thread which isn't an atomic read-modify-write would overwrite them.
+     */
+    void toggle(uint32_t thread, std::atomic<uint32_t> &corrupted)
+    {
+        uint32_t mine = ((1u << PINS_PER_THREAD) - 1) << (thread * PINS_PER_THREAD);
+        uint32_t errors = 0;
+        for (uint32_t i = 0; i < TOGGLES; i++)
+        {
+            bool high = i & 1;
+            GpioBanks::writeBank(0, high ? mine : 0, high ? 0 : mine);
+            if ((GpioBanks::readOutputBank(0) & mine) != (high ? mine : 0))
+            {
+                errors++;
+            }
+        }
+        corrupted.fetch_add(errors, std::memory_order_relaxed);
+    }
+
+    void benchmarkConcurrentToggles()
+    {
+        SimulatedGpioRegisters &registers = SimulatedGpioRegisters::instance();
+        printf("threads  stores/s total  stores/s per thread\n");
+        for (size_t threads = 1; threads <= MAX_THREADS; threads *= 2)
+        {
+            registers.reset();
+            std::atomic<uint32_t> corrupted{0};
+            std::array<std::thread, MAX_THREADS> workers;
+
+            auto start = std::chrono::steady_clock::now();
+            for (size_t t = 0; t < threads; t++)
+            {
+                workers[t] = std::thread(toggle, static_cast<uint32_t>(t), std::ref(corrupted));
+            }
+            for (size_t t = 0; t < threads; t++)
+            {
+                workers[t].join();
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            uint32_t expected = static_cast<uint32_t>(threads) * TOGGLES;
+            printf("%7zu  %14.0f  %19.0f\n", threads, expected / seconds, TOGGLES / seconds);
+
+            TEST_ASSERT_EQUAL_UINT32(expected, registers.getStoreCount());
+            TEST_ASSERT_EQUAL_UINT32(0, corrupted.load());
+            // every thread ended with a high store
+            uint32_t all = (1u << (threads * PINS_PER_THREAD)) - 1;
+            TEST_ASSERT_EQUAL_HEX32(all, registers.readOutput(0));
+        }
+    }
+}
+
+void runSimulatedGpioBenchmarks()
+{
+    RUN_TEST(benchmarkConcurrentToggles);
+}
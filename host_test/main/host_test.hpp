@@ -0,0 +1,15 @@
+#pragma once
+
+/*
+ * Every test file runs its tests with RUN_TEST() in one function, called by app_main().
+ */
+void runGpioBanksTests();
+void runSimulatedGpioBenchmarks();
+void runPinSetBenchmarks();
+void runGpioDelayBenchmarks();
+void runPinEventCountersTests();
+void runGpioTests();
+void runGpioTraceTests();
+void runSimulatedDevicesTests();
+void runSimulatedNetsTests();
+void runInfraRedTests();
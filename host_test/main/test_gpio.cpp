@@ -0,0 +1,75 @@
+#include <utility>
+#include "unity.h"
+#include "Gpio.hpp"
+#include "SimulatedGpio.hpp"
+#include "host_test.hpp"
+
+using namespace Components;
+
+namespace
+{
+    constexpr uint32_t PIN = 4;
+    constexpr uint32_t BIT = 1u << PIN;
+
+    void countCall(void *arg)
+    {
+        ++*static_cast<uint32_t *>(arg);
+    }
+
+    void testOutputDrivesRegisters()
+    {
+        SimulatedGpioRegisters &registers = SimulatedGpioRegisters::instance();
+        PinOutput output{GPIONum(PIN)};
+        TEST_ASSERT_EQUAL_HEX32(BIT, registers.getOutputEnable(0));
+        TEST_ASSERT_EQUAL_HEX32(BIT, registers.getPullUp(0));
+
+        output.setHigh();
+        TEST_ASSERT_EQUAL_HEX32(BIT, registers.readOutput(0));
+        output.setLow();
+        TEST_ASSERT_EQUAL_HEX32(0, registers.readOutput(0));
+
+        PinInput input = std::move(output).intoInput();
+        TEST_ASSERT_EQUAL_HEX32(0, registers.getOutputEnable(0));
+        registers.setExternal(PIN, true);
+        TEST_ASSERT_TRUE(input.getLevel() == GPIOLevel::HIGH);
+    }
+
+    void testPadSettingsReadBack()
+    {
+        PinOutput output{GPIONum(PIN)};
+        TEST_ASSERT_TRUE(output.getDriveStrength() == GPIODriveStrength::DEFAULT());
+        output.setDriveStrength(GPIODriveStrength::STRONGEST());
+        TEST_ASSERT_TRUE(output.getDriveStrength() == GPIODriveStrength::STRONGEST());
+
+        // a new object resets the pin
+        PinOutput again{GPIONum(PIN)};
+        TEST_ASSERT_TRUE(again.getDriveStrength() == GPIODriveStrength::DEFAULT());
+    }
+
+    void testSimulatedInterrupt()
+    {
+        uint32_t calls = 0;
+        PinInput input{GPIONum(PIN)};
+        input.wakeupEnable(GPIOWakeupIntrType::HIGH_LEVEL());
+        input.wakeupDisable();
+
+        simulateInterrupt(PIN);
+        TEST_ASSERT_EQUAL_UINT32(0, calls);
+
+        input.interruptEnable(GPIOIntrType::POSEDGE(), countCall, &calls);
+        simulateInterrupt(PIN);
+        simulateInterrupt(PIN);
+        TEST_ASSERT_EQUAL_UINT32(2, calls);
+
+        input.interruptDisable();
+        simulateInterrupt(PIN);
+        TEST_ASSERT_EQUAL_UINT32(2, calls);
+    }
+}
+
+void runGpioTests()
+{
+    RUN_TEST(testOutputDrivesRegisters);
+    RUN_TEST(testPadSettingsReadBack);
+    RUN_TEST(testSimulatedInterrupt);
+}
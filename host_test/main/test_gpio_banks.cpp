@@ -0,0 +1,131 @@
+#include "unity.h"
+#include "GpioBanks.hpp"
+#include "SimulatedGpio.hpp"
+#include "host_test.hpp"
+
+using namespace Components;
+
+namespace
+{
+    // two pins in each bank
+    constexpr uint32_t LOW_A = 2;
+    constexpr uint32_t LOW_B = 5;
+    constexpr uint32_t HIGH_A = 33;
+    constexpr uint32_t HIGH_B = 35;
+
+    constexpr uint32_t bit(uint32_t pin)
+    {
+        return 1u << (pin % GpioMask::BANK_BITS);
+    }
+
+    uint32_t stores()
+    {
+        return SimulatedGpioRegisters::instance().getStoreCount();
+    }
+
+    void testWriteSplitsBanks()
+    {
+        GpioBanks::setHigh(GpioMask::fromPins({LOW_A, HIGH_A}));
+        TEST_ASSERT_EQUAL_HEX32(bit(LOW_A), GpioBanks::readOutputBank(0));
+        TEST_ASSERT_EQUAL_HEX32(bit(HIGH_A), GpioBanks::readOutputBank(1));
+        TEST_ASSERT_EQUAL_UINT32(2, stores());
+
+        // bank 0 needs a set and a clear, bank 1 only a clear
+        GpioBanks::write(GpioMask::fromPins({LOW_B}), GpioMask::fromPins({LOW_A, HIGH_A}));
+        TEST_ASSERT_EQUAL_HEX32(bit(LOW_B), GpioBanks::readOutputBank(0));
+        TEST_ASSERT_EQUAL_HEX32(0, GpioBanks::readOutputBank(1));
+        TEST_ASSERT_EQUAL_UINT32(5, stores());
+    }
+
+    void testWriteSkipsUntouchedBanks()
+    {
+        GpioBanks::setHigh(GpioMask::fromPins({HIGH_A, HIGH_B}));
+        TEST_ASSERT_EQUAL_UINT32(1, stores());
+
+        GpioBanks::setLow(GpioMask::fromPins({LOW_A}));
+        TEST_ASSERT_EQUAL_UINT32(2, stores());
+        TEST_ASSERT_EQUAL_HEX32(bit(HIGH_A) | bit(HIGH_B), GpioBanks::readOutputBank(1));
+
+        GpioBanks::write(GpioMask(), GpioMask());
+        GpioBanks::writeBank(1, 0, 0);
+        TEST_ASSERT_EQUAL_UINT32(2, stores());
+    }
+
+    void testAssignAcrossBanks()
+    {
+        GpioBanks::setHigh(GpioMask::fromPins({LOW_A, HIGH_A}));
+        uint32_t before = stores();
+
+        GpioMask pins = GpioMask::fromPins({LOW_A, LOW_B, HIGH_A, HIGH_B});
+        GpioBanks::assign(pins, GpioMask::fromPins({LOW_B, HIGH_B}));
+        TEST_ASSERT_EQUAL_HEX32(bit(LOW_B), GpioBanks::readOutputBank(0));
+        TEST_ASSERT_EQUAL_HEX32(bit(HIGH_B), GpioBanks::readOutputBank(1));
+        TEST_ASSERT_EQUAL_UINT32(before + 4, stores());
+
+        // levels outside of pins are ignored
+        GpioBanks::assign(GpioMask::fromPins({HIGH_A}), GpioMask::fromPins({LOW_A, HIGH_A}));
+        TEST_ASSERT_EQUAL_HEX32(bit(LOW_B), GpioBanks::readOutputBank(0));
+        TEST_ASSERT_EQUAL_HEX32(bit(HIGH_A) | bit(HIGH_B), GpioBanks::readOutputBank(1));
+        TEST_ASSERT_EQUAL_UINT32(before + 5, stores());
+    }
+
+    void testAssignBankIsOneStore()
+    {
+        GpioBanks::setHigh(GpioMask::fromPins({LOW_A, HIGH_A}));
+        uint32_t before = stores();
+
+        GpioBanks::assignBank(0, bit(LOW_A) | bit(LOW_B), bit(LOW_B));
+        TEST_ASSERT_EQUAL_HEX32(bit(LOW_B), GpioBanks::readOutputBank(0));
+        TEST_ASSERT_EQUAL_HEX32(bit(HIGH_A), GpioBanks::readOutputBank(1));
+        TEST_ASSERT_EQUAL_UINT32(before + 1, stores());
+    }
+
+    void testReadAcrossBanks()
+    {
+        SimulatedGpioRegisters &registers = SimulatedGpioRegisters::instance();
+        registers.setExternal(LOW_A, true);
+        registers.setExternal(HIGH_B, true);
+        registers.setExternal(6, true);
+
+        GpioMask levels = GpioBanks::read(GpioMask::fromPins({LOW_A, LOW_B, HIGH_A, HIGH_B}));
+        TEST_ASSERT_EQUAL_HEX64(GpioMask::fromPins({LOW_A, HIGH_B}).toBits(), levels.toBits());
+        TEST_ASSERT_EQUAL_HEX64(GpioMask::fromPins({HIGH_B}).toBits(),
+                                GpioBanks::read(GpioMask::fromPins({HIGH_A, HIGH_B})).toBits());
+
+        // enabled outputs read back their latch
+        registers.setOutputEnable(1, bit(HIGH_A) | bit(HIGH_B));
+        GpioBanks::write(GpioMask::fromPins({HIGH_A}), GpioMask::fromPins({HIGH_B}));
+        TEST_ASSERT_EQUAL_HEX32(bit(HIGH_A), GpioBanks::readBank(1) & (bit(HIGH_A) | bit(HIGH_B)));
+        TEST_ASSERT_EQUAL_HEX32(bit(HIGH_A) | bit(HIGH_B), GpioBanks::readEnableBank(1));
+        TEST_ASSERT_EQUAL_UINT32(2, stores());
+    }
+
+    void testTemplatesMatchRuntime()
+    {
+        constexpr GpioMask SET = GpioMask::fromPins({LOW_A, HIGH_A});
+        constexpr GpioMask CLEAR = GpioMask::fromPins({HIGH_B});
+
+        GpioBanks::write<SET, CLEAR>();
+        TEST_ASSERT_EQUAL_HEX32(bit(LOW_A), GpioBanks::readOutputBank(0));
+        TEST_ASSERT_EQUAL_HEX32(bit(HIGH_A), GpioBanks::readOutputBank(1));
+        TEST_ASSERT_EQUAL_UINT32(3, stores());
+
+        GpioBanks::write<GpioMask::fromPins({HIGH_B})>();
+        TEST_ASSERT_EQUAL_UINT32(4, stores());
+
+        SimulatedGpioRegisters::instance().setExternal(HIGH_A, true);
+        constexpr GpioMask PINS = GpioMask::fromPins({LOW_B, HIGH_A});
+        TEST_ASSERT_EQUAL_HEX64(GpioBanks::read(PINS).toBits(), GpioBanks::read<PINS>().toBits());
+        TEST_ASSERT_EQUAL_HEX64(GpioMask::fromPins({HIGH_A}).toBits(), GpioBanks::read<PINS>().toBits());
+    }
+}
+
+void runGpioBanksTests()
+{
+    RUN_TEST(testWriteSplitsBanks);
+    RUN_TEST(testWriteSkipsUntouchedBanks);
+    RUN_TEST(testAssignAcrossBanks);
+    RUN_TEST(testAssignBankIsOneStore);
+    RUN_TEST(testReadAcrossBanks);
+    RUN_TEST(testTemplatesMatchRuntime);
+}
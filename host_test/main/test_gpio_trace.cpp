@@ -0,0 +1,232 @@
+#include "unity.h"
+#include "Gpio.hpp"
+#include "GpioClock.hpp"
+#include "GpioTrace.hpp"
+#include "SimulatedGpio.hpp"
+#include "host_test.hpp"
+
+using namespace Components;
+
+namespace
+{
+    constexpr uint32_t PIN_A = 4;
+    constexpr uint32_t PIN_B = 5;
+    constexpr size_t TRACE_WORDS = 16;
+
+    uint32_t trace[TRACE_WORDS];
+
+    /*
+     * Called as the interrupt handler of PIN_A, reads the pin like a typical handler does.
+     */
+    struct HandlerContext
+    {
+        PinInput *pin;
+        uint32_t calls;
+        GPIOLevel level;
+    };
+
+    void readInHandler(void *arg)
+    {
+        HandlerContext *context = static_cast<HandlerContext *>(arg);
+        context->calls++;
+        context->level = context->pin->getLevel();
+    }
+
+    void setExternal(uint32_t pin, bool level)
+    {
+        SimulatedGpioRegisters::instance().setExternal(pin, level);
+    }
+
+    void expectRecord(GpioTraceReader &reader, uint64_t time_us, uint32_t pin, GpioTraceEvent event, GPIOLevel level)
+    {
+        GpioTraceRecord record;
+        TEST_ASSERT_TRUE(reader.next(record));
+        TEST_ASSERT_EQUAL_UINT64(time_us, record.time_us);
+        TEST_ASSERT_EQUAL_UINT32(pin, record.pin);
+        TEST_ASSERT_TRUE(record.event == event);
+        TEST_ASSERT_TRUE(record.level == level);
+    }
+
+    /*
+     * Interrupt on A at 0 with a read of A in its handler, a read of B at 1000 and another interrupt at 1500.
+     */
+    size_t recordInterruptTrace()
+    {
+        PinInput pin_a{GPIONum(PIN_A)};
+        PinInput pin_b{GPIONum(PIN_B)};
+        HandlerContext context{&pin_a, 0, GPIOLevel::LOW};
+        pin_a.interruptEnable(GPIOIntrType::ANYEDGE(), readInHandler, &context);
+
+        GpioTraceRecorder::start(trace, TRACE_WORDS);
+        setExternal(PIN_A, true);
+        simulateInterrupt(PIN_A);
+        GpioClock::advanceUs(1000);
+        pin_b.getLevel();
+        GpioClock::advanceUs(500);
+        setExternal(PIN_A, false);
+        simulateInterrupt(PIN_A);
+        GpioTraceRecorder::stop();
+
+        pin_a.interruptDisable();
+        return GpioTraceRecorder::size();
+    }
+
+    void testRecordReadBack()
+    {
+        GpioClock::setVirtual(true);
+        PinInput pin{GPIONum(PIN_A)};
+        GpioTraceRecorder::start(trace, TRACE_WORDS);
+        setExternal(PIN_A, true);
+        pin.getLevel();
+        GpioClock::advanceUs(100);
+        setExternal(PIN_A, false);
+        pin.getLevel();
+        // two time extension words, each covering MAX_DELTA_US
+        GpioClock::advanceUs(2 * GpioTraceRecorder::MAX_DELTA_US + 50);
+        pin.getLevel();
+        GpioTraceRecorder::stop();
+        pin.getLevel();
+        GpioClock::setVirtual(false);
+
+        TEST_ASSERT_EQUAL_UINT32(5, GpioTraceRecorder::size());
+        TEST_ASSERT_EQUAL_UINT32(0, GpioTraceRecorder::dropped());
+        TEST_ASSERT_EQUAL_UINT32(GpioTraceRecorder::TIME_EXTENSION_PIN, trace[2] >> 26);
+
+        GpioTraceReader reader(trace, GpioTraceRecorder::size());
+        expectRecord(reader, 0, PIN_A, GpioTraceEvent::READ, GPIOLevel::HIGH);
+        expectRecord(reader, 100, PIN_A, GpioTraceEvent::READ, GPIOLevel::LOW);
+        expectRecord(reader, 150 + 2 * GpioTraceRecorder::MAX_DELTA_US, PIN_A, GpioTraceEvent::READ, GPIOLevel::LOW);
+        GpioTraceRecord record;
+        TEST_ASSERT_FALSE(reader.next(record));
+
+        reader.rewind();
+        TEST_ASSERT_TRUE(reader.peek(record));
+        expectRecord(reader, 0, PIN_A, GpioTraceEvent::READ, GPIOLevel::HIGH);
+    }
+
+    void testDropWhenFull()
+    {
+        GpioClock::setVirtual(true);
+        PinInput pin{GPIONum(PIN_A)};
+        GpioTraceRecorder::start(trace, 3);
+        pin.getLevel();
+        GpioClock::advanceUs(GpioTraceRecorder::MAX_DELTA_US + 1);
+        pin.getLevel();
+        TEST_ASSERT_EQUAL_UINT32(3, GpioTraceRecorder::size());
+        pin.getLevel();
+        TEST_ASSERT_EQUAL_UINT32(3, GpioTraceRecorder::size());
+        TEST_ASSERT_EQUAL_UINT32(1, GpioTraceRecorder::dropped());
+
+        // an event doesn't fit if its time extension words don't
+        GpioTraceRecorder::start(trace, 3);
+        pin.getLevel();
+        GpioClock::advanceUs(2 * GpioTraceRecorder::MAX_DELTA_US);
+        pin.getLevel();
+        TEST_ASSERT_EQUAL_UINT32(1, GpioTraceRecorder::size());
+        TEST_ASSERT_EQUAL_UINT32(1, GpioTraceRecorder::dropped());
+        GpioTraceRecorder::stop();
+        GpioClock::setVirtual(false);
+
+        GpioTraceReader reader(trace, GpioTraceRecorder::size());
+        expectRecord(reader, 0, PIN_A, GpioTraceEvent::READ, GPIOLevel::LOW);
+        GpioTraceRecord record;
+        TEST_ASSERT_FALSE(reader.next(record));
+    }
+
+    void testReplayServesReads()
+    {
+        GpioClock::setVirtual(true);
+        PinInput pin_a{GPIONum(PIN_A)};
+        PinInput pin_b{GPIONum(PIN_B)};
+        GpioTraceRecorder::start(trace, TRACE_WORDS);
+        setExternal(PIN_A, true);
+        pin_a.getLevel();
+        GpioClock::advanceUs(10);
+        pin_b.getLevel();
+        GpioClock::advanceUs(20);
+        setExternal(PIN_A, false);
+        pin_a.getLevel();
+        GpioTraceRecorder::stop();
+        size_t words = GpioTraceRecorder::size();
+
+        SimulatedGpioRegisters::instance().reset();
+        setExternal(PIN_B, true);
+        GpioTraceReplayer replayer(trace, words);
+        replayer.attach();
+        uint64_t start_us = GpioClock::nowUs();
+
+        TEST_ASSERT_TRUE(pin_a.getLevel() == GPIOLevel::HIGH);
+        // the next recorded read is of B, so this one is served from the simulated input
+        TEST_ASSERT_TRUE(pin_a.getLevel() == GPIOLevel::HIGH);
+        TEST_ASSERT_EQUAL_UINT32(1, replayer.mismatches());
+
+        TEST_ASSERT_TRUE(pin_b.getLevel() == GPIOLevel::LOW);
+        TEST_ASSERT_EQUAL_UINT64(10, GpioClock::nowUs() - start_us);
+        TEST_ASSERT_TRUE(pin_a.getLevel() == GPIOLevel::LOW);
+        TEST_ASSERT_EQUAL_UINT64(30, replayer.timeUs());
+        TEST_ASSERT_TRUE(replayer.finished());
+
+        // reads after the end are no mismatches
+        pin_b.getLevel();
+        TEST_ASSERT_EQUAL_UINT32(1, replayer.mismatches());
+        replayer.detach();
+        GpioClock::setVirtual(false);
+    }
+
+    void testReplayDeliversInterrupts()
+    {
+        GpioClock::setVirtual(true);
+        size_t words = recordInterruptTrace();
+        TEST_ASSERT_EQUAL_UINT32(5, words);
+
+        SimulatedGpioRegisters::instance().reset();
+        PinInput pin_a{GPIONum(PIN_A)};
+        PinInput pin_b{GPIONum(PIN_B)};
+        HandlerContext context{&pin_a, 0, GPIOLevel::LOW};
+        pin_a.interruptEnable(GPIOIntrType::ANYEDGE(), readInHandler, &context);
+
+        // pull mode: the main loop delivers the interrupts, the reads in the handler consume their records
+        GpioTraceReplayer replayer(trace, words);
+        replayer.attach();
+        uint64_t start_us = GpioClock::nowUs();
+        TEST_ASSERT_EQUAL_UINT32(1, replayer.deliverInterrupts());
+        TEST_ASSERT_EQUAL_UINT32(1, context.calls);
+        TEST_ASSERT_TRUE(context.level == GPIOLevel::HIGH);
+        TEST_ASSERT_EQUAL_UINT32(0, replayer.deliverInterrupts());
+
+        TEST_ASSERT_TRUE(pin_b.getLevel() == GPIOLevel::LOW);
+        TEST_ASSERT_EQUAL_UINT32(1, replayer.deliverInterrupts());
+        TEST_ASSERT_EQUAL_UINT32(2, context.calls);
+        TEST_ASSERT_TRUE(context.level == GPIOLevel::LOW);
+        TEST_ASSERT_EQUAL_UINT64(1500, GpioClock::nowUs() - start_us);
+        TEST_ASSERT_EQUAL_UINT32(0, replayer.mismatches());
+        TEST_ASSERT_TRUE(replayer.finished());
+        replayer.detach();
+
+        // push mode: step() applies the recorded levels and calls the handler
+        GpioTraceReplayer pusher(trace, words);
+        context.calls = 0;
+        start_us = GpioClock::nowUs();
+        TEST_ASSERT_TRUE(pusher.step());
+        TEST_ASSERT_EQUAL_UINT32(1, context.calls);
+        TEST_ASSERT_TRUE(context.level == GPIOLevel::HIGH);
+        // not attached, so the reads recorded in the handler are delivered as events of their own
+        TEST_ASSERT_EQUAL_UINT32(2, pusher.runUntil(1000));
+        TEST_ASSERT_EQUAL_UINT64(1000, GpioClock::nowUs() - start_us);
+        TEST_ASSERT_EQUAL_UINT32(2, pusher.run());
+        TEST_ASSERT_EQUAL_UINT32(2, context.calls);
+        TEST_ASSERT_EQUAL_UINT64(1500, pusher.timeUs());
+        TEST_ASSERT_FALSE(pusher.step());
+
+        pin_a.interruptDisable();
+        GpioClock::setVirtual(false);
+    }
+}
+
+void runGpioTraceTests()
+{
+    RUN_TEST(testRecordReadBack);
+    RUN_TEST(testDropWhenFull);
+    RUN_TEST(testReplayServesReads);
+    RUN_TEST(testReplayDeliversInterrupts);
+}
@@ -0,0 +1,68 @@
+#include "unity.h"
+#include "GpioClock.hpp"
+#include "InfraRed.hpp"
+#include "SimulatedGpio.hpp"
+#include "host_test.hpp"
+
+using namespace Components;
+
+namespace
+{
+    constexpr uint32_t PIN = 4;
+    constexpr uint32_t GAP_US = 20000;
+
+    // address 0x04, commands 0x08 and 0x09, each followed by its inverse
+    constexpr uint32_t FIRST = 0xF708FB04;
+    constexpr uint32_t SECOND = 0xF609FB04;
+
+    void setInput(bool level)
+    {
+        SimulatedGpioRegisters::instance().setExternal(PIN, level);
+        simulateInterrupt(PIN);
+    }
+
+    /*
+     * Plays \c data through an active low receiver output, the line stays high after the last mark.
+     */
+    void play(uint32_t data)
+    {
+        IRFrame frame;
+        TEST_ASSERT_EQUAL_UINT32(ESP_OK, IRCodec::encode(IRCode{IRProtocol::NEC, data, 32, false}, frame));
+        for (size_t i = 0; i < frame.symbol_count; i++)
+        {
+            setInput(false);
+            GpioClock::advanceUs(frame.symbols[i].mark_us);
+            setInput(true);
+            GpioClock::advanceUs(frame.symbols[i].space_us);
+        }
+    }
+
+    void testFrameKeptWhenNextStarts()
+    {
+        GpioClock::setVirtual(true);
+        SimulatedGpioRegisters::instance().setExternal(PIN, true);
+        {
+            IRReceiver receiver{GPIONum(PIN)};
+            IRCode code;
+            play(FIRST);
+            GpioClock::advanceUs(GAP_US);
+            // the next frame starts before poll() ran
+            play(SECOND);
+
+            TEST_ASSERT_EQUAL_UINT32(ESP_OK, receiver.poll(code));
+            TEST_ASSERT_EQUAL_HEX32(FIRST, code.data);
+            TEST_ASSERT_EQUAL_UINT32(ESP_ERR_NOT_FOUND, receiver.poll(code));
+
+            GpioClock::advanceUs(GAP_US);
+            TEST_ASSERT_EQUAL_UINT32(ESP_OK, receiver.poll(code));
+            TEST_ASSERT_EQUAL_HEX32(SECOND, code.data);
+            TEST_ASSERT_EQUAL_UINT32(ESP_ERR_NOT_FOUND, receiver.poll(code));
+        }
+        GpioClock::setVirtual(false);
+    }
+}
+
+void runInfraRedTests()
+{
+    RUN_TEST(testFrameKeptWhenNextStarts);
+}
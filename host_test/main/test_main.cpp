@@ -0,0 +1,31 @@
+#include <cstdlib>
+#include "unity.h"
+#include "SimulatedGpio.hpp"
+#include "host_test.hpp"
+
+using namespace Components;
+
+void setUp()
+{
+    SimulatedGpioRegisters::instance().reset();
+}
+
+void tearDown()
+{
+}
+
+extern "C" void app_main(void)
+{
+    UNITY_BEGIN();
+    runGpioBanksTests();
+    runSimulatedGpioBenchmarks();
+    runPinSetBenchmarks();
+    runGpioDelayBenchmarks();
+    runPinEventCountersTests();
+    runGpioTests();
+    runGpioTraceTests();
+    runSimulatedDevicesTests();
+    runSimulatedNetsTests();
+    runInfraRedTests();
+    exit(UNITY_END());
+}
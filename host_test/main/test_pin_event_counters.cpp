@@ -0,0 +1,59 @@
+#include "unity.h"
+#include "PinEventCounters.hpp"
+#include "host_test.hpp"
+
+using namespace Components;
+
+namespace
+{
+    // stands in for the counter variable of a ULP program
+    volatile uint32_t ulp_edges;
+
+    uint32_t countOf(uint32_t pin)
+    {
+        PinEventRecord records[PinEventCounters::MAX_PINS];
+        size_t count = PinEventCounters::read(records, PinEventCounters::MAX_PINS);
+        for (size_t i = 0; i < count; i++)
+        {
+            if (records[i].pin == pin)
+            {
+                return records[i].count;
+            }
+        }
+        return 0;
+    }
+
+    /*
+     * Every boot runs track(), attachUlpCounter() and recordWakeup(), the edges counted by the ULP in between
+     * must survive the second attach.
+     */
+    void testUlpEdgesSurviveReattach()
+    {
+        PinEventCounters::clear();
+        ulp_edges = 0xfff0;
+        PinEventCounters::track(GPIONum(4));
+        PinEventCounters::attachUlpCounter(GPIONum(4), &ulp_edges);
+        PinEventCounters::recordWakeup();
+        TEST_ASSERT_EQUAL_UINT32(0, countOf(4));
+
+        // deep sleep, the 16 bit ULP counter wraps
+        ulp_edges = 0x0005;
+
+        PinEventCounters::track(GPIONum(4));
+        PinEventCounters::attachUlpCounter(GPIONum(4), &ulp_edges);
+        PinEventCounters::recordWakeup();
+        TEST_ASSERT_EQUAL_UINT32(0x15, countOf(4));
+        TEST_ASSERT_EQUAL_UINT32(0x15, PinEventCounters::pendingEvents());
+
+        // a different mask starts from the current value again
+        ulp_edges = 0x10007;
+        PinEventCounters::attachUlpCounter(GPIONum(4), &ulp_edges, 0xffffffff);
+        PinEventCounters::recordWakeup();
+        TEST_ASSERT_EQUAL_UINT32(0x15, countOf(4));
+    }
+}
+
+void runPinEventCountersTests()
+{
+    RUN_TEST(testUlpEdgesSurviveReattach);
+}
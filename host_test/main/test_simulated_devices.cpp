@@ -0,0 +1,517 @@
+#include <cstring>
+#include "unity.h"
+#include "Gpio.hpp"
+#include "GpioClock.hpp"
+#include "SimulatedDevices.hpp"
+#include "SimulatedNets.hpp"
+#include "host_test.hpp"
+
+using namespace Components;
+
+namespace
+{
+    constexpr uint32_t PULL_UP_OHMS = 4700;
+
+    void wait(uint32_t us)
+    {
+        GpioClock::delayUs(us);
+    }
+
+    /*
+     * Bit-banged masters of the device protocols, as an application would write them.
+     */
+    struct I2cMaster
+    {
+        PinOutputInput &sda;
+        PinOutputInput &scl;
+
+        void start()
+        {
+            sda.setFloating();
+            scl.setFloating();
+            wait(5);
+            sda.setLow();
+            wait(5);
+            scl.setLow();
+            wait(5);
+        }
+
+        void stop()
+        {
+            sda.setLow();
+            wait(5);
+            scl.setFloating();
+            wait(5);
+            sda.setFloating();
+            wait(5);
+        }
+
+        bool write(uint8_t byte)
+        {
+            for (int bit = 7; bit >= 0; bit--)
+            {
+                if ((byte >> bit) & 1)
+                {
+                    sda.setFloating();
+                }
+                else
+                {
+                    sda.setLow();
+                }
+                wait(5);
+                scl.setFloating();
+                wait(5);
+                scl.setLow();
+            }
+            sda.setFloating();
+            wait(5);
+            scl.setFloating();
+            wait(5);
+            bool ack = sda.getLevel() == GPIOLevel::LOW;
+            scl.setLow();
+            wait(5);
+            return ack;
+        }
+
+        uint8_t read(bool ack)
+        {
+            uint8_t byte = 0;
+            sda.setFloating();
+            for (int bit = 0; bit < 8; bit++)
+            {
+                wait(5);
+                scl.setFloating();
+                wait(5);
+                byte = (byte << 1) | (sda.getLevel() == GPIOLevel::HIGH);
+                scl.setLow();
+            }
+            if (ack)
+            {
+                sda.setLow();
+            }
+            wait(5);
+            scl.setFloating();
+            wait(5);
+            scl.setLow();
+            sda.setFloating();
+            wait(5);
+            return byte;
+        }
+    };
+
+    struct SpiMaster
+    {
+        PinOutput &cs;
+        PinOutput &sck;
+        PinOutput &mosi;
+        PinInput &miso;
+
+        uint8_t transfer(uint8_t byte)
+        {
+            uint8_t received = 0;
+            for (int bit = 7; bit >= 0; bit--)
+            {
+                if ((byte >> bit) & 1)
+                {
+                    mosi.setHigh();
+                }
+                else
+                {
+                    mosi.setLow();
+                }
+                sck.setHigh();
+                received = (received << 1) | (miso.getLevel() == GPIOLevel::HIGH);
+                sck.setLow();
+            }
+            return received;
+        }
+
+        void command(const uint8_t *bytes, size_t size)
+        {
+            cs.setLow();
+            for (size_t i = 0; i < size; i++)
+            {
+                transfer(bytes[i]);
+            }
+            cs.setHigh();
+        }
+
+        uint8_t status()
+        {
+            cs.setLow();
+            transfer(0x05);
+            uint8_t value = transfer(0);
+            cs.setHigh();
+            return value;
+        }
+    };
+
+    struct OneWireMaster
+    {
+        PinOutputInput &dq;
+
+        bool reset()
+        {
+            dq.setLow();
+            wait(480);
+            dq.setFloating();
+            wait(70);
+            bool presence = dq.getLevel() == GPIOLevel::LOW;
+            wait(410);
+            return presence;
+        }
+
+        void writeBit(bool bit)
+        {
+            dq.setLow();
+            wait(bit ? 6 : 60);
+            dq.setFloating();
+            wait(bit ? 64 : 10);
+        }
+
+        bool readBit()
+        {
+            dq.setLow();
+            wait(3);
+            dq.setFloating();
+            wait(10);
+            bool bit = dq.getLevel() == GPIOLevel::HIGH;
+            wait(53);
+            return bit;
+        }
+
+        void write(uint8_t byte)
+        {
+            for (int bit = 0; bit < 8; bit++)
+            {
+                writeBit((byte >> bit) & 1);
+            }
+        }
+
+        uint8_t read()
+        {
+            uint8_t byte = 0;
+            for (int bit = 0; bit < 8; bit++)
+            {
+                byte |= readBit() << bit;
+            }
+            return byte;
+        }
+
+        /*
+         * One pass of the SEARCH ROM algorithm, \c last_discrepancy is -1 for the first pass.
+         *
+         * @return the discrepancy to continue with, -1 after the last device.
+         */
+        int search(uint64_t &rom, int last_discrepancy)
+        {
+            int discrepancy = -1;
+            write(0xF0);
+            uint64_t found = 0;
+            for (int bit = 0; bit < 64; bit++)
+            {
+                bool id = readBit();
+                bool complement = readBit();
+                bool direction = id;
+                if (id == complement)
+                {
+                    direction = bit < last_discrepancy ? (rom >> bit) & 1 : bit == last_discrepancy;
+                    if (!direction)
+                    {
+                        discrepancy = bit;
+                    }
+                }
+                found |= static_cast<uint64_t>(direction) << bit;
+                writeBit(direction);
+            }
+            rom = found;
+            return discrepancy;
+        }
+    };
+
+    void testShiftRegister()
+    {
+        GpioClock::setVirtual(true);
+        SimulatedNets nets;
+        size_t data_net = nets.addNet();
+        size_t clock_net = nets.addNet();
+        size_t latch_net = nets.addNet();
+        nets.connectPin(data_net, 16);
+        nets.connectPin(clock_net, 17);
+        nets.connectPin(latch_net, 18);
+        PinOutput data{GPIONum(16)};
+        PinOutput clock{GPIONum(17)};
+        PinOutput latch{GPIONum(18)};
+
+        {
+            SimulatedShiftRegister chips(nets, data_net, clock_net, latch_net, 16);
+            for (int bit = 15; bit >= 0; bit--)
+            {
+                if ((0xBEEF >> bit) & 1)
+                {
+                    data.setHigh();
+                }
+                else
+                {
+                    data.setLow();
+                }
+                clock.setHigh();
+                clock.setLow();
+            }
+            TEST_ASSERT_EQUAL_HEX32(0, chips.getOutputs());
+            latch.setHigh();
+            latch.setLow();
+            TEST_ASSERT_EQUAL_HEX32(0xBEEF, chips.getOutputs());
+            TEST_ASSERT_EQUAL_UINT32(16, chips.getClockCount());
+
+            // a second, 8 bit chain on the same lines keeps only the last 8 bits
+            SimulatedShiftRegister chip(nets, data_net, clock_net, latch_net);
+            data.setHigh();
+            for (int bit = 0; bit < 9; bit++)
+            {
+                clock.setHigh();
+                clock.setLow();
+            }
+            latch.setHigh();
+            TEST_ASSERT_EQUAL_HEX32(0xFF, chip.getOutputs());
+            TEST_ASSERT_EQUAL_HEX32(((0xBEEF << 9) | 0x1FF) & 0xFFFF, chips.getOutputs());
+        }
+        GpioClock::setVirtual(false);
+    }
+
+    void testI2cEeprom()
+    {
+        GpioClock::setVirtual(true);
+        SimulatedNets nets;
+        size_t sda_net = nets.addNet(50);
+        size_t scl_net = nets.addNet(50);
+        nets.addPull(sda_net, PULL_UP_OHMS, true);
+        nets.addPull(scl_net, PULL_UP_OHMS, true);
+        nets.connectPin(sda_net, 4);
+        nets.connectPin(scl_net, 5);
+        PinOutputInput sda{GPIONum(4)};
+        PinOutputInput scl{GPIONum(5)};
+        I2cMaster bus{sda, scl};
+
+        uint8_t memory[512];
+        memset(memory, 0xFF, sizeof(memory));
+        {
+            SimulatedI2cEeprom eeprom(nets, sda_net, scl_net, memory, sizeof(memory), 0x50, 16);
+
+            // three bytes from 0x10E on, the page pointer wraps to the start of the page
+            bus.start();
+            TEST_ASSERT_TRUE(bus.write(0xA0));
+            TEST_ASSERT_TRUE(bus.write(0x01));
+            TEST_ASSERT_TRUE(bus.write(0x0E));
+            TEST_ASSERT_TRUE(bus.write(0x11));
+            TEST_ASSERT_TRUE(bus.write(0x22));
+            TEST_ASSERT_TRUE(bus.write(0x33));
+            bus.stop();
+            // the STOP condition is a released SDA rising with the pull-up, which nothing has sampled yet
+            nets.poll();
+            uint64_t written_us = GpioClock::nowUs();
+            TEST_ASSERT_EQUAL_UINT32(1, eeprom.getWriteCount());
+            TEST_ASSERT_EQUAL_HEX32(0x11, memory[0x10E]);
+            TEST_ASSERT_EQUAL_HEX32(0x22, memory[0x10F]);
+            TEST_ASSERT_EQUAL_HEX32(0x33, memory[0x100]);
+            TEST_ASSERT_EQUAL_HEX32(0xFF, memory[0x110]);
+
+            // acknowledge polling: the address is not acknowledged during the write cycle
+            uint32_t polls = 0;
+            bool ack = false;
+            while (!ack && polls < 100)
+            {
+                bus.start();
+                ack = bus.write(0xA0);
+                polls++;
+                if (!ack)
+                {
+                    bus.stop();
+                    wait(100);
+                }
+            }
+            TEST_ASSERT_TRUE(ack);
+            TEST_ASSERT_GREATER_THAN_UINT32(1, polls);
+            TEST_ASSERT_GREATER_OR_EQUAL_UINT32(5000, GpioClock::nowUs() - written_us);
+
+            // random read of the written bytes, continued as a sequential read
+            TEST_ASSERT_TRUE(bus.write(0x01));
+            TEST_ASSERT_TRUE(bus.write(0x0E));
+            bus.start();
+            TEST_ASSERT_TRUE(bus.write(0xA1));
+            TEST_ASSERT_EQUAL_HEX32(0x11, bus.read(true));
+            TEST_ASSERT_EQUAL_HEX32(0x22, bus.read(false));
+            bus.stop();
+
+            bus.start();
+            TEST_ASSERT_FALSE(bus.write(0xA2));
+            bus.stop();
+            TEST_ASSERT_EQUAL_UINT32(1, eeprom.getWriteCount());
+        }
+        TEST_ASSERT_EQUAL_UINT32(0, nets.getTotalContentions());
+        GpioClock::setVirtual(false);
+    }
+
+    void testSpiFlash()
+    {
+        GpioClock::setVirtual(true);
+        SimulatedNets nets;
+        size_t cs_net = nets.addNet();
+        size_t sck_net = nets.addNet();
+        size_t mosi_net = nets.addNet();
+        size_t miso_net = nets.addNet();
+        nets.connectPin(cs_net, 12);
+        nets.connectPin(sck_net, 13);
+        nets.connectPin(mosi_net, 14);
+        nets.connectPin(miso_net, 15);
+        PinOutput cs{GPIONum(12)};
+        PinOutput sck{GPIONum(13)};
+        PinOutput mosi{GPIONum(14)};
+        PinInput miso{GPIONum(15)};
+        cs.setHigh();
+        SpiMaster bus{cs, sck, mosi, miso};
+
+        static uint8_t memory[8192];
+        memset(memory, 0xFF, sizeof(memory));
+        memory[0x0FFF] = 0x5A;
+        memory[0x1001] = 0xAA;
+        {
+            SimulatedSpiFlash flash(nets, cs_net, sck_net, mosi_net, miso_net, memory, sizeof(memory));
+            cs.setLow();
+            bus.transfer(0x9F);
+            TEST_ASSERT_EQUAL_HEX32(0xEF, bus.transfer(0));
+            TEST_ASSERT_EQUAL_HEX32(0x40, bus.transfer(0));
+            TEST_ASSERT_EQUAL_HEX32(0x16, bus.transfer(0));
+            cs.setHigh();
+
+            // programming needs the write enable latch
+            const uint8_t PROGRAM[] = {0x02, 0x00, 0x10, 0xFE, 0x11, 0x22, 0x33, 0x0F};
+            bus.command(PROGRAM, sizeof(PROGRAM));
+            TEST_ASSERT_EQUAL_HEX32(0xFF, memory[0x10FE]);
+            TEST_ASSERT_EQUAL_HEX32(0, bus.status());
+
+            // wraps inside the page and only clears bits
+            const uint8_t WRITE_ENABLE[] = {0x06};
+            bus.command(WRITE_ENABLE, sizeof(WRITE_ENABLE));
+            TEST_ASSERT_EQUAL_HEX32(0x02, bus.status());
+            bus.command(PROGRAM, sizeof(PROGRAM));
+            TEST_ASSERT_EQUAL_HEX32(0x01, bus.status());
+            TEST_ASSERT_EQUAL_HEX32(0x11, memory[0x10FE]);
+            TEST_ASSERT_EQUAL_HEX32(0x22, memory[0x10FF]);
+            TEST_ASSERT_EQUAL_HEX32(0x33, memory[0x1000]);
+            TEST_ASSERT_EQUAL_HEX32(0x0A, memory[0x1001]);
+            TEST_ASSERT_EQUAL_HEX32(0xFF, memory[0x1100]);
+
+            // commands other than READ STATUS are ignored while busy
+            bus.command(WRITE_ENABLE, sizeof(WRITE_ENABLE));
+            wait(SimulatedSpiFlash::PAGE_PROGRAM_US);
+            TEST_ASSERT_EQUAL_HEX32(0, bus.status());
+
+            cs.setLow();
+            bus.transfer(0x03);
+            bus.transfer(0x00);
+            bus.transfer(0x10);
+            bus.transfer(0xFE);
+            TEST_ASSERT_EQUAL_HEX32(0x11, bus.transfer(0));
+            TEST_ASSERT_EQUAL_HEX32(0x22, bus.transfer(0));
+            // reads don't wrap at the page
+            TEST_ASSERT_EQUAL_HEX32(0xFF, bus.transfer(0));
+            cs.setHigh();
+
+            const uint8_t SECTOR_ERASE[] = {0x20, 0x00, 0x10, 0x80};
+            bus.command(WRITE_ENABLE, sizeof(WRITE_ENABLE));
+            bus.command(SECTOR_ERASE, sizeof(SECTOR_ERASE));
+            TEST_ASSERT_EQUAL_HEX32(0xFF, memory[0x1000]);
+            TEST_ASSERT_EQUAL_HEX32(0xFF, memory[0x10FF]);
+            TEST_ASSERT_EQUAL_HEX32(0x5A, memory[0x0FFF]);
+            wait(SimulatedSpiFlash::SECTOR_ERASE_US - 100);
+            TEST_ASSERT_EQUAL_HEX32(0x01, bus.status());
+            wait(100);
+            TEST_ASSERT_EQUAL_HEX32(0, bus.status());
+        }
+        GpioClock::setVirtual(false);
+    }
+
+    void testOneWireSensors()
+    {
+        GpioClock::setVirtual(true);
+        SimulatedNets nets;
+        size_t dq_net = nets.addNet(200);
+        nets.addPull(dq_net, PULL_UP_OHMS, true);
+        nets.connectPin(dq_net, 19);
+        PinOutputInput dq{GPIONum(19)};
+        dq.setFloating();
+        OneWireMaster bus{dq};
+        TEST_ASSERT_FALSE(bus.reset());
+
+        {
+            SimulatedOneWireSensor first(nets, dq_net, 0x123456789ABCull);
+            SimulatedOneWireSensor second(nets, dq_net, 0x0000000000AAull);
+            first.setTemperature(21.5f);
+            second.setTemperature(-10.25f);
+            TEST_ASSERT_TRUE(bus.reset());
+
+            // the search visits the ROM with the 0 bit at the first discrepancy first
+            uint64_t roms[2] = {};
+            uint64_t rom = 0;
+            int discrepancy = -1;
+            for (uint64_t &found : roms)
+            {
+                TEST_ASSERT_TRUE(bus.reset());
+                discrepancy = bus.search(rom, discrepancy);
+                found = rom;
+                TEST_ASSERT_EQUAL_UINT32(0, SimulatedOneWireSensor::crc8(reinterpret_cast<uint8_t *>(&rom), 8));
+            }
+            TEST_ASSERT_EQUAL_INT(-1, discrepancy);
+            TEST_ASSERT_TRUE(roms[0] != roms[1]);
+            TEST_ASSERT_TRUE(roms[0] == first.getRom() || roms[0] == second.getRom());
+            TEST_ASSERT_TRUE(roms[1] == first.getRom() || roms[1] == second.getRom());
+            TEST_ASSERT_EQUAL_HEX32(SimulatedOneWireSensor::FAMILY_CODE, first.getRom() & 0xFF);
+
+            // CONVERT T for both, read slots return 0 until the 750 ms of 12 bit resolution are over
+            bus.reset();
+            bus.write(0xCC);
+            bus.write(0x44);
+            uint64_t start_us = GpioClock::nowUs();
+            uint32_t polls = 0;
+            while (!bus.readBit() && polls < 20000)
+            {
+                polls++;
+            }
+            TEST_ASSERT_GREATER_THAN_UINT32(0, polls);
+            TEST_ASSERT_GREATER_OR_EQUAL_UINT32(750000, GpioClock::nowUs() - start_us);
+
+            const SimulatedOneWireSensor *sensors[] = {&first, &second};
+            // 1/16 degree per bit
+            const int16_t expected[] = {344, -164};
+            for (size_t i = 0; i < 2; i++)
+            {
+                bus.reset();
+                bus.write(0x55);
+                uint64_t selected = sensors[i]->getRom();
+                for (int byte = 0; byte < 8; byte++)
+                {
+                    bus.write(selected >> (8 * byte));
+                }
+                bus.write(0xBE);
+                uint8_t scratchpad[9];
+                for (uint8_t &byte : scratchpad)
+                {
+                    byte = bus.read();
+                }
+                TEST_ASSERT_EQUAL_UINT32(0, SimulatedOneWireSensor::crc8(scratchpad, sizeof(scratchpad)));
+                TEST_ASSERT_EQUAL_INT(expected[i], static_cast<int16_t>(scratchpad[0] | (scratchpad[1] << 8)));
+            }
+            TEST_ASSERT_EQUAL_UINT32(0, nets.getContentions(dq_net));
+        }
+        GpioClock::setVirtual(false);
+    }
+}
+
+void runSimulatedDevicesTests()
+{
+    RUN_TEST(testShiftRegister);
+    RUN_TEST(testI2cEeprom);
+    RUN_TEST(testSpiFlash);
+    RUN_TEST(testOneWireSensors);
+}
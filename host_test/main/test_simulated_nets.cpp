@@ -0,0 +1,138 @@
+#include "unity.h"
+#include "Gpio.hpp"
+#include "GpioClock.hpp"
+#include "SimulatedNets.hpp"
+#include "host_test.hpp"
+
+using namespace Components;
+
+namespace
+{
+    void testContentionCounting()
+    {
+        GpioClock::setVirtual(true);
+        SimulatedNets nets;
+        size_t net = nets.addNet();
+        size_t port = nets.addPort(net);
+        nets.connectPin(net, 4);
+        nets.connectPin(net, 5);
+        PinOutput first{GPIONum(4)};
+        PinOutput second{GPIONum(5)};
+
+        // the first pin going high while the second still drives low is the first contention
+        first.setHigh();
+        TEST_ASSERT_TRUE(nets.isContended(net));
+        second.setHigh();
+        TEST_ASSERT_FALSE(nets.isContended(net));
+        TEST_ASSERT_TRUE(nets.getLevel(net));
+        TEST_ASSERT_EQUAL_UINT32(1, nets.getContentions(net));
+
+        // the level stays where it was while the drivers disagree
+        second.setLow();
+        TEST_ASSERT_TRUE(nets.isContended(net));
+        TEST_ASSERT_TRUE(nets.getLevel(net));
+        TEST_ASSERT_EQUAL_UINT32(2, nets.getContentions(net));
+
+        // a contention only counts once, however many drivers join it
+        nets.drive(port, NetDrive::LOW);
+        TEST_ASSERT_EQUAL_UINT32(2, nets.getContentions(net));
+
+        first.setLow();
+        TEST_ASSERT_FALSE(nets.isContended(net));
+        TEST_ASSERT_FALSE(nets.getLevel(net));
+
+        nets.drive(port, NetDrive::HIGH);
+        TEST_ASSERT_EQUAL_UINT32(3, nets.getContentions(net));
+        TEST_ASSERT_EQUAL_UINT32(3, nets.getTotalContentions());
+        nets.drive(port, NetDrive::RELEASED);
+        TEST_ASSERT_FALSE(nets.isContended(net));
+        GpioClock::setVirtual(false);
+    }
+
+    void testReleasedOpenDrainRises()
+    {
+        GpioClock::setVirtual(true);
+        SimulatedNets nets;
+        size_t net = nets.addNet(100);
+        nets.connectPin(net, 4);
+        PinOutputInput pin{GPIONum(4)};
+        pin.setPullMode(GPIOPullMode::PULLUP());
+        pin.setLow();
+        TEST_ASSERT_TRUE(pin.getLevel() == GPIOLevel::LOW);
+
+        // 0.69 * 45 kOhm * 100 pF = 3.1 us
+        pin.setFloating();
+        uint64_t settling_ns = nets.settlingNs(net);
+        TEST_ASSERT_GREATER_OR_EQUAL_UINT32(3000, settling_ns);
+        TEST_ASSERT_LESS_OR_EQUAL_UINT32(3200, settling_ns);
+        GpioClock::skipNs(3000);
+        TEST_ASSERT_TRUE(pin.getLevel() == GPIOLevel::LOW);
+        GpioClock::skipNs(200);
+        TEST_ASSERT_TRUE(pin.getLevel() == GPIOLevel::HIGH);
+        TEST_ASSERT_EQUAL_UINT64(0, nets.settlingNs(net));
+
+        // an external 4.7 kOhm pull-up in parallel makes it about ten times faster
+        nets.addPull(net, 4700, true);
+        pin.setLow();
+        pin.setFloating();
+        settling_ns = nets.settlingNs(net);
+        TEST_ASSERT_GREATER_OR_EQUAL_UINT32(280, settling_ns);
+        TEST_ASSERT_LESS_OR_EQUAL_UINT32(310, settling_ns);
+
+        // driven edges are visible right away
+        pin.setLow();
+        TEST_ASSERT_TRUE(pin.getLevel() == GPIOLevel::LOW);
+        GpioClock::setVirtual(false);
+    }
+
+    void testUndecidedNetsKeepLevel()
+    {
+        GpioClock::setVirtual(true);
+        SimulatedNets nets;
+        size_t divider = nets.addNet();
+        size_t open = nets.addNet();
+        nets.addPull(divider, 10000, true);
+        nets.addPull(divider, 10000, false);
+        size_t divider_port = nets.addPort(divider);
+        size_t open_port = nets.addPort(open);
+        nets.connectPin(divider, 4);
+        PinInput divider_pin{GPIONum(4)};
+        // the reset enabled the internal pull-up
+        divider_pin.setPullMode(GPIOPullMode::FLOATING());
+
+        // equal pulls keep the level the net was driven to
+        for (NetDrive drive : {NetDrive::HIGH, NetDrive::LOW})
+        {
+            nets.drive(divider_port, drive);
+            nets.drive(divider_port, NetDrive::RELEASED);
+            GpioClock::skipNs(100000);
+            TEST_ASSERT_TRUE(divider_pin.getLevel() == (drive == NetDrive::HIGH ? GPIOLevel::HIGH : GPIOLevel::LOW));
+            TEST_ASSERT_FALSE(nets.isFloating(divider));
+        }
+
+        // the internal pull-up of the pin tips the balance
+        divider_pin.setPullMode(GPIOPullMode::PULLUP());
+        GpioClock::skipNs(100000);
+        TEST_ASSERT_TRUE(divider_pin.getLevel() == GPIOLevel::HIGH);
+
+        // a net without drivers or pulls keeps its charge
+        nets.drive(open_port, NetDrive::HIGH);
+        TEST_ASSERT_FALSE(nets.isFloating(open));
+        nets.drive(open_port, NetDrive::RELEASED);
+        GpioClock::skipNs(100000);
+        TEST_ASSERT_TRUE(nets.isFloating(open));
+        TEST_ASSERT_TRUE(nets.getLevel(open));
+        TEST_ASSERT_EQUAL_UINT64(0, nets.settlingNs(open));
+        nets.drive(open_port, NetDrive::LOW);
+        nets.drive(open_port, NetDrive::RELEASED);
+        TEST_ASSERT_FALSE(nets.getLevel(open));
+        GpioClock::setVirtual(false);
+    }
+}
+
+void runSimulatedNetsTests()
+{
+    RUN_TEST(testContentionCounting);
+    RUN_TEST(testReleasedOpenDrainRises);
+    RUN_TEST(testUndecidedNetsKeepLevel);
+}
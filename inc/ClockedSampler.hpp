@@ -0,0 +1,124 @@
+#pragma once
+
+#if __cpp_exceptions
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include "Gpio.hpp"
+#include "GpioMask.hpp"
+#include "GpioPowerLock.hpp"
+
+namespace Components
+{
+    /**
+     * @brief Samples one or more data pins on the edges of a clock pin.
+     *
+     * Every clock edge produces one sample with one bit per data pin (bit i is data pin i), stored back to back in
+     * a bit packed ring buffer provided by the user. Samples arriving while the ring is full are dropped and counted
+     * as overflows.
+     *
+     * Two capture modes are available:
+     *  - interrupt mode (\c start()), for slow clocks up to some ten kHz, the CPU is free between edges
+     *  - busy loop mode (\c captureBlocking()), which polls the input registers directly and follows clocks in the
+     *    hundreds of kHz at the cost of occupying the calling core for the duration of the transfer
+     *
+     * In both modes the CPU is kept at its maximum frequency (\c GpioPowerLock) while sampling.
+     */
+    class ClockedSampler
+    {
+    public:
+        static constexpr size_t MAX_DATA_PINS = 8;
+
+        /**
+         * @param clock Pin providing the clock.
+         * @param data Data pins, at most \c MAX_DATA_PINS.
+         * @param buffer Storage for the samples, must outlive the sampler.
+         * @param buffer_size Size of \c buffer in bytes. The usable capacity is rounded down to a power of two samples.
+         * @param edge Clock edge to sample on, POSEDGE, NEGEDGE or ANYEDGE.
+         *
+         * @throws GPIOException
+         *              - with ESP_ERR_INVALID_ARG if there are no or too many data pins or the buffer is too small
+         */
+        ClockedSampler(PinInput &clock,
+                       std::initializer_list<std::reference_wrapper<const PinInput>> data,
+                       uint8_t *buffer,
+                       size_t buffer_size,
+                       GPIOIntrType edge = GPIOIntrType::POSEDGE());
+        ~ClockedSampler();
+
+        ClockedSampler(const ClockedSampler &) = delete;
+        ClockedSampler &operator=(const ClockedSampler &) = delete;
+
+        /**
+         * @brief Start sampling on the clock interrupt.
+         *
+         * @throws GPIOException
+         *              - if the underlying driver function fails
+         */
+        void start();
+
+        /**
+         * @brief Stop sampling on the clock interrupt.
+         *
+         * @throws GPIOException
+         *              - if the underlying driver function fails
+         */
+        void stop();
+
+        /**
+         * @brief Poll the clock in a busy loop until \c samples were taken or \c timeout_us passed.
+         *
+         * Should not be combined with a running interrupt mode capture.
+         *
+         * @return the number of samples taken, including dropped ones.
+         */
+        size_t captureBlocking(size_t samples, uint32_t timeout_us) noexcept;
+
+        /**
+         * @brief Move up to \c max_samples of the oldest samples to \c out, packed the same way as in the ring.
+         *
+         * \c out must hold at least (max_samples * data pin count + 7) / 8 bytes.
+         *
+         * @return the number of samples copied.
+         */
+        size_t read(uint8_t *out, size_t max_samples) noexcept;
+
+        size_t available() const noexcept;
+
+        /**
+         * @brief Number of samples lost because the ring was full.
+         */
+        uint32_t overflows() const noexcept;
+
+        size_t getBitsPerSample() const noexcept
+        {
+            return data_count;
+        }
+
+    private:
+        static void isrHandler(void *arg);
+
+        GpioMask readInputs() const noexcept;
+        void store(const GpioMask &inputs) noexcept;
+
+        PinInput &clock;
+        GPIOIntrType edge;
+        std::array<uint8_t, MAX_DATA_PINS> data_pins;
+        size_t data_count;
+        GpioMask input_mask;
+        uint8_t *buffer;
+        size_t capacity;
+        std::atomic<size_t> head;
+        std::atomic<size_t> tail;
+        std::atomic<uint32_t> overflow_count;
+        GpioPowerLock &power_lock;
+        bool running;
+    };
+
+}
+
+#endif
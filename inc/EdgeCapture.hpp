@@ -0,0 +1,117 @@
+#pragma once
+
+#if __cpp_exceptions
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "Gpio.hpp"
+
+namespace Components
+{
+    /**
+     * @brief A single captured edge: the time it was seen and the level of the pin after the edge.
+     *
+     * Timestamps are the lower 32 bit of \c GpioClock::nowUs(), durations are computed with unsigned wrap around.
+     */
+    struct GPIOEdge
+    {
+        uint32_t time_us;
+        GPIOLevel level;
+    };
+
+    /**
+     * @brief Lock free single producer, single consumer ring of edges captured from a GPIO interrupt.
+     *
+     * The interrupt handler only stores a timestamp and the level, all decoding is done later in task context by
+     * draining the ring in batches. If the ring is full, new edges are dropped and counted as overflows.
+     *
+     * This is the non-template base, use \c EdgeCapture with a capacity to get the storage.
+     */
+    class EdgeCaptureBase
+    {
+    public:
+        EdgeCaptureBase(const EdgeCaptureBase &) = delete;
+        EdgeCaptureBase &operator=(const EdgeCaptureBase &) = delete;
+
+        /**
+         * @brief Start capturing edges of \c pin.
+         *
+         * @throws GPIOException
+         *              - if the underlying driver function fails
+         */
+        void start(PinInput &pin, GPIOIntrType type = GPIOIntrType::ANYEDGE());
+
+        /**
+         * @brief Stop capturing. Already captured edges stay readable.
+         *
+         * @throws GPIOException
+         *              - if the underlying driver function fails
+         */
+        void stop();
+
+        /**
+         * @brief Append an edge. Safe to call from ISR context, also usable to feed edges from other sources.
+         */
+        void push(uint32_t time_us, GPIOLevel level) noexcept;
+
+        /**
+         * @brief Move up to \c max_count of the oldest edges into \c edges.
+         *
+         * @return the number of edges copied.
+         */
+        size_t read(GPIOEdge *edges, size_t max_count) noexcept;
+
+        size_t available() const noexcept;
+        void clear() noexcept;
+
+        /**
+         * @brief Number of edges dropped because the ring was full.
+         */
+        uint32_t overflows() const noexcept;
+
+    protected:
+        /**
+         * @param storage Buffer for the edges, must outlive this object.
+         * @param capacity Number of edges in \c storage, must be a power of two.
+         */
+        EdgeCaptureBase(GPIOEdge *storage, size_t capacity) noexcept;
+
+    private:
+        static void isrHandler(void *arg);
+
+        GPIOEdge *storage;
+        size_t mask;
+        std::atomic<size_t> head;
+        std::atomic<size_t> tail;
+        std::atomic<uint32_t> overflow_count;
+        PinInput *pin;
+        size_t pin_bank;
+        uint32_t pin_bit;
+    };
+
+    /**
+     * @brief Storage of \c EdgeCapture, a separate base so it is constructed before \c EdgeCaptureBase.
+     */
+    template <size_t CAPACITY>
+    struct EdgeCaptureStorage
+    {
+        std::array<GPIOEdge, CAPACITY> buffer;
+    };
+
+    /**
+     * @brief Edge capture ring with statically sized storage for \c CAPACITY edges.
+     */
+    template <size_t CAPACITY>
+    class EdgeCapture : private EdgeCaptureStorage<CAPACITY>, public EdgeCaptureBase
+    {
+        static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+
+    public:
+        EdgeCapture() noexcept : EdgeCaptureStorage<CAPACITY>{}, EdgeCaptureBase(this->buffer.data(), CAPACITY) {}
+    };
+
+}
+
+#endif
@@ -0,0 +1,133 @@
+#pragma once
+
+#if __cpp_exceptions
+
+#include <cstdint>
+#include "Gpio.hpp"
+#include "GpioBanks.hpp"
+#include "GpioMask.hpp"
+
+namespace Components
+{
+    namespace FastPinDetail
+    {
+        /**
+         * @brief Bank and bit of a pin number known at compile time.
+         */
+        template <uint32_t NUM>
+        struct PinBits
+        {
+            static_assert(isValidPinConstexpr(NUM), "invalid GPIO number");
+
+            static constexpr size_t BANK = NUM / GpioMask::BANK_BITS;
+            static constexpr uint32_t BIT = 1u << (NUM % GpioMask::BANK_BITS);
+        };
+
+        /**
+         * @brief Make sure the fast pin refers to the same GPIO as the configured pin it is created from.
+         */
+        inline void checkNum(const GPIO &pin, uint32_t num)
+        {
+            if (pin.getNum().get_value<uint32_t>() != num)
+            {
+                throw GPIOException(ESP_ERR_INVALID_ARG);
+            }
+        }
+    }
+
+    /**
+     * @brief Register level access to an output with the pin number fixed at compile time.
+     *
+     * Has the same interface as \c PinOutput, so templates constrained on \c WritablePin accept both. Each call
+     * is a single store of a constant to the set or clear register, without driver call and without exceptions.
+     *
+     * The pin has to be configured by a \c PinOutput, which also has to outlive this object.
+     */
+    template <uint32_t NUM>
+    class FastPinOutput
+    {
+    public:
+        /**
+         * @throws GPIOException
+         *              - with ESP_ERR_INVALID_ARG if \c pin is not GPIO \c NUM
+         */
+        explicit FastPinOutput(const PinOutput &pin)
+        {
+            FastPinDetail::checkNum(pin, NUM);
+        }
+
+        void setHigh() noexcept
+        {
+            GpioBanks::writeBank<Bits::BANK, Bits::BIT, 0>();
+        }
+
+        void setLow() noexcept
+        {
+            GpioBanks::writeBank<Bits::BANK, 0, Bits::BIT>();
+        }
+
+    private:
+        using Bits = FastPinDetail::PinBits<NUM>;
+    };
+
+    /**
+     * @brief Register level access to an input with the pin number fixed at compile time.
+     *
+     * Same interface as \c PinInput::getLevel(), reads the input register of the pin's bank directly.
+     * The pin has to be configured by a \c PinInput, which also has to outlive this object.
+     */
+    template <uint32_t NUM>
+    class FastPinInput
+    {
+    public:
+        /**
+         * @throws GPIOException
+         *              - with ESP_ERR_INVALID_ARG if \c pin is not GPIO \c NUM
+         */
+        explicit FastPinInput(const PinInput &pin)
+        {
+            FastPinDetail::checkNum(pin, NUM);
+        }
+
+        GPIOLevel getLevel() const noexcept
+        {
+            return GpioBanks::readBank(Bits::BANK) & Bits::BIT ? GPIOLevel::HIGH : GPIOLevel::LOW;
+        }
+
+    private:
+        using Bits = FastPinDetail::PinBits<NUM>;
+    };
+
+    /**
+     * @brief Register level access to an open drain output and input with the pin number fixed at compile time.
+     *
+     * Same interface as \c PinOutputInput for levels. The pin has to be configured by a \c PinOutputInput, which
+     * also has to outlive this object.
+     */
+    template <uint32_t NUM>
+    class FastPinOutputInput : public FastPinInput<NUM>
+    {
+    public:
+        /**
+         * @throws GPIOException
+         *              - with ESP_ERR_INVALID_ARG if \c pin is not GPIO \c NUM
+         */
+        explicit FastPinOutputInput(const PinOutputInput &pin) : FastPinInput<NUM>(pin) { }
+
+        void setFloating() noexcept
+        {
+            GpioBanks::writeBank<Bits::BANK, Bits::BIT, 0>();
+        }
+
+        void setLow() noexcept
+        {
+            GpioBanks::writeBank<Bits::BANK, 0, Bits::BIT>();
+        }
+
+    private:
+        using Bits = FastPinDetail::PinBits<NUM>;
+    };
+
+}
+
+#endif
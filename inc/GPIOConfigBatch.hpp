@@ -0,0 +1,74 @@
+#pragma once
+
+#if __cpp_exceptions
+
+#include <array>
+#include <cstdint>
+#include "Gpio.hpp"
+#include "GpioMask.hpp"
+
+namespace Components
+{
+    /**
+     * @brief Records pull mode and drive strength changes of many pins and applies them in one pass.
+     *
+     * Calling \c PinInput::setPullMode() and \c PinOutput::setDriveStrength() one after another costs a driver call
+     * and an IO MUX read-modify-write each. A batch collects the settings instead, \c commit() then writes the IO MUX
+     * register of every touched pin exactly once, with both settings merged.
+     *
+     * Pads which aren't plain IO MUX pads (see \c isPlainIoMuxPad()) are configured through the driver instead:
+     * pads whose pulls or drive are controlled by the RTC IO block (e.g. the RTC pads of the ESP32), the USB pads
+     * of the ESP32-C3 and ESP32-S3, whose D+ pull-up is also controlled by the USB Serial/JTAG peripheral, and
+     * GPIO17 and GPIO18 of the ESP32-S2 with swapped drive strength bits. On the Linux target, everything goes
+     * through the driver.
+     */
+    class GPIOConfigBatch
+    {
+    public:
+        GPIOConfigBatch() noexcept;
+
+        void setPullMode(const PinInput &pin, GPIOPullMode mode) noexcept;
+        void setDriveStrength(const PinOutput &pin, GPIODriveStrength strength) noexcept;
+        void setDriveStrength(const PinOutputInput &pin, GPIODriveStrength strength) noexcept;
+
+        /**
+         * @brief Apply all recorded settings and empty the batch.
+         *
+         * @throws GPIOException
+         *              - if the underlying driver function fails
+         *              - with ESP_ERR_INVALID_ARG if a pin has no IO MUX register
+         */
+        void commit();
+
+        /**
+         * @brief Drop all recorded settings.
+         */
+        void clear() noexcept;
+
+        /**
+         * @brief The pins with recorded settings.
+         */
+        const GpioMask &getPending() const noexcept
+        {
+            return pending;
+        }
+
+    private:
+        struct PinSettings
+        {
+            uint8_t pull : 2;
+            uint8_t pull_set : 1;
+            uint8_t drive : 2;
+            uint8_t drive_set : 1;
+            uint8_t reserved : 2;
+        };
+
+        void recordDriveStrength(uint32_t pin, GPIODriveStrength strength) noexcept;
+
+        GpioMask pending;
+        std::array<PinSettings, GPIO_NUM_MAX> settings;
+    };
+
+}
+
+#endif
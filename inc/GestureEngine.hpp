@@ -0,0 +1,161 @@
+#pragma once
+
+#if __cpp_exceptions
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "Gpio.hpp"
+#include "GpioMask.hpp"
+
+struct esp_timer;
+
+namespace Components
+{
+    /**
+     * @brief Gestures recognized by the \c GestureEngine.
+     */
+    enum class GestureType : uint8_t
+    {
+        CLICK,
+        DOUBLE_CLICK,
+        LONG_PRESS,
+        HOLD_REPEAT,
+        LONG_RELEASE
+    };
+
+    struct GestureEvent
+    {
+        uint8_t button;
+        GestureType type;
+    };
+
+    /**
+     * @brief Gesture timings, all in ticks of the engine.
+     */
+    struct GestureTiming
+    {
+        /**
+         * @brief Number of equal consecutive samples (1 to 8) before a level change is accepted.
+         */
+        uint8_t debounce_samples;
+        uint16_t long_press_ticks;
+        uint16_t repeat_ticks;
+        uint16_t double_click_gap_ticks;
+    };
+
+    /**
+     * @brief Recognizes click, double click, long press and hold repeat on many buttons with one periodic tick.
+     *
+     * Every tick samples all button pins with one input register read per bank, debounces them and advances the
+     * per button state machines, which are kept in a compact array. Recognized gestures are put into a lock free
+     * single producer, single consumer queue, so the tick can run in a timer callback while a task consumes the
+     * events with \c poll(). Neither interrupts nor timers are needed per button.
+     */
+    class GestureEngine
+    {
+    public:
+        static constexpr size_t MAX_BUTTONS = 32;
+        static constexpr size_t QUEUE_SIZE = 32;
+
+        /**
+         * @param timing Gesture timings, e.g. for a 10ms tick {3, 60, 20, 30}.
+         */
+        explicit GestureEngine(const GestureTiming &timing) noexcept;
+        ~GestureEngine();
+
+        GestureEngine(const GestureEngine &) = delete;
+        GestureEngine &operator=(const GestureEngine &) = delete;
+
+        /**
+         * @brief Add a button. Buttons must be added before the engine is started.
+         *
+         * @param active_low True if the pin reads low while the button is pressed.
+         * @return the index of the button, as reported in \c GestureEvent::button.
+         *
+         * @throws GPIOException
+         *              - with ESP_ERR_NO_MEM if \c MAX_BUTTONS buttons exist already
+         */
+        size_t addButton(const PinInput &pin, bool active_low = true);
+
+        /**
+         * @brief Call \c tick() every \c period_us from an esp_timer.
+         *
+         * On the Linux target, a virtual timer of \c GpioClock is used instead, which ticks as virtual time advances.
+         *
+         * @throws GPIOException
+         *              - if the underlying driver function fails
+         */
+        void start(uint32_t period_us);
+
+        /**
+         * @throws GPIOException
+         *              - if the underlying driver function fails
+         */
+        void stop();
+
+        /**
+         * @brief Sample all buttons and advance their state machines by one tick.
+         */
+        void tick() noexcept;
+
+        /**
+         * @brief Take the oldest gesture event from the queue.
+         *
+         * @return false if the queue is empty.
+         */
+        bool poll(GestureEvent &event) noexcept;
+
+        /**
+         * @brief Number of events lost because the queue was full.
+         */
+        uint32_t getDroppedEvents() const noexcept
+        {
+            return dropped_events.load(std::memory_order_relaxed);
+        }
+
+    private:
+        enum State : uint8_t
+        {
+            IDLE,
+            PRESSED,
+            HOLDING,
+            WAIT_NEXT
+        };
+
+        struct Button
+        {
+            uint8_t pin;
+            uint8_t history;
+            uint8_t pressed : 1;
+            uint8_t active_low : 1;
+            uint8_t state : 2;
+            uint8_t clicks : 4;
+            uint8_t reserved;
+            uint16_t ticks;
+        };
+
+        static_assert(sizeof(Button) == 6, "Button state should stay compact");
+
+        void advance(uint8_t index, Button &button, bool pressed) noexcept;
+        void emit(uint8_t button, GestureType type) noexcept;
+
+        GestureTiming timing;
+        uint8_t debounce_mask;
+        GpioMask pins;
+        size_t button_count;
+        std::array<Button, MAX_BUTTONS> buttons;
+        std::array<GestureEvent, QUEUE_SIZE> queue;
+        std::atomic<size_t> head;
+        std::atomic<size_t> tail;
+        std::atomic<uint32_t> dropped_events;
+        esp_timer *timer;
+#if CONFIG_IDF_TARGET_LINUX
+        int virtual_timer = -1;
+#endif
+    };
+
+}
+
+#endif
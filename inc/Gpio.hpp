@@ -2,6 +2,8 @@
 
 #if __cpp_exceptions
 
+#include <cassert>
+#include <cstddef>
 #include "Exceptions.hpp"
 #include "System.hpp"
 using namespace System;
@@ -17,11 +19,38 @@ namespace Components
      */
     esp_err_t isValidPin(uint32_t pin_num) noexcept;
 
+    /**
+     * Check if all \c count pin numbers in \c pin_nums are valid on the current hardware.
+     *
+     * The pins are folded into one bit mask which is then checked against all valid pins at once, so this is
+     * considerably cheaper than calling \c isValidPin() for each pin of a large table.
+     */
+    esp_err_t isValidPins(const uint32_t *pin_nums, size_t count) noexcept;
+
+    /**
+     * @brief Tag type to select the non-validating constructor of \c GPIONumBase.
+     */
+    struct UncheckedPin
+    {
+        explicit UncheckedPin() = default;
+    };
+
+    /**
+     * @brief Tag value to construct a GPIO number from a trusted, already validated source.
+     */
+    inline constexpr UncheckedPin unchecked{};
+
     /**
      * Check if the numeric value of a drive strength is valid on the current hardware.
      */
     esp_err_t isValidDriveStrengthPin(uint32_t strength) noexcept;
 
+    /**
+     * Check if pull and drive of the pin are controlled by its IO MUX register alone. On other pins, e.g. RTC IO
+     * pads, the registers must be accessed through the driver. Always false on the Linux target.
+     */
+    bool isPlainIoMuxPad(uint32_t pin_num) noexcept;
+
     /**
      * This is a "Strong Value Type" class for GPIO. The GPIO pin number is checked during construction according to
      * the hardware capabilities. This means that any GPIONumBase object is guaranteed to contain a valid GPIO number.
@@ -45,6 +74,17 @@ namespace Components
             }
         }
 
+        /**
+         * @brief Create a numerical pin number representation without checking it.
+         *
+         * Meant for hot paths and pin tables which were validated before, e.g. with \c isValidPins().
+         * Passing an invalid number is undefined behavior; debug builds assert on it.
+         */
+        GPIONumBase(UncheckedPin, uint32_t pin) noexcept : StrongValueComparable<uint32_t>(pin)
+        {
+            assert(isValidPin(pin) == ESP_OK);
+        }
+
         using StrongValueComparable<uint32_t>::operator==;
         using StrongValueComparable<uint32_t>::operator!=;
     };
@@ -128,6 +168,38 @@ namespace Components
         static GPIOWakeupIntrType HIGH_LEVEL();
     };
 
+    /**
+     * @brief Represents a valid interrupt trigger type for GPIO inputs.
+     *
+     * This class is a "Strong Value Type", see also the template class \c StrongValue for more properties.
+     * It is supposed to resemble an enum type, hence it has static creation methods and a private constructor.
+     */
+    class GPIOIntrType final : public StrongValueComparable<uint32_t>
+    {
+    private:
+        /**
+         * Constructor is private since it should only be accessed by the static creation methods.
+         *
+         * @param interrupt_type A valid numerical respresentation of an interrupt trigger. Must be valid!
+         */
+        explicit GPIOIntrType(uint32_t interrupt_type) : StrongValueComparable<uint32_t>(interrupt_type) {}
+
+    public:
+        static GPIOIntrType POSEDGE();
+        static GPIOIntrType NEGEDGE();
+        static GPIOIntrType ANYEDGE();
+        static GPIOIntrType LOW_LEVEL();
+        static GPIOIntrType HIGH_LEVEL();
+
+        using StrongValueComparable<uint32_t>::operator==;
+        using StrongValueComparable<uint32_t>::operator!=;
+    };
+
+    /**
+     * Signature of a GPIO interrupt handler. Handlers run in ISR context and must be placed in IRAM.
+     */
+    using GPIOISRHandler = void (*)(void *arg);
+
     /**
      * Class representing a valid drive strength for GPIO outputs.
      * This class is a "Strong Value Type", see also the template class \c StrongValue for more properties.
@@ -192,6 +264,10 @@ namespace Components
         using StrongValueComparable<uint32_t>::operator!=;
     };
 
+    class PinOutput;
+    class PinInput;
+    class PinOutputInput;
+
     /**
      * @brief Implementations commonly used functionality for all GPIO configurations.
      *
@@ -215,6 +291,31 @@ namespace Components
          *              - if the underlying driver function fails
          */
         GPIO(GPIONum num);
+
+        /**
+         * @brief Tag selecting the constructors which take over an already configured pin.
+         */
+        struct Reconfigure
+        {
+        };
+
+        /**
+         * @brief Take over an already configured GPIO without resetting it.
+         *
+         * Used by the mode transitions, pull mode, drive strength and hold configuration are kept.
+         */
+        GPIO(GPIONum num, Reconfigure) noexcept : gpio_num(num) {}
+
+    public:
+        /**
+         * @brief The number of the configured GPIO pin.
+         */
+        GPIONum getNum() const noexcept
+        {
+            return gpio_num;
+        }
+
+    protected:
         void holdEnable();
         void holdDisable();
         void setDriveStrength(GPIODriveStrength strength);
@@ -244,8 +345,36 @@ namespace Components
         void setHigh();
         void setLow();
 
+        /**
+         * @brief Turn this output into an input without resetting the pin.
+         *
+         * Only the direction is changed, the pull and drive configuration is kept.
+         * The object is consumed, don't use it afterwards.
+         *
+         * @throws GPIOException
+         *              - if the underlying driver function fails
+         */
+        PinInput intoInput() &&;
+
+        /**
+         * @brief Turn this output into an open drain output and input without resetting the pin.
+         *
+         * The pin is released (floating) before the direction changes.
+         * The object is consumed, don't use it afterwards.
+         *
+         * @throws GPIOException
+         *              - if the underlying driver function fails
+         */
+        PinOutputInput intoOutputInput() &&;
+
         using GPIO::getDriveStrength;
         using GPIO::setDriveStrength;
+
+    private:
+        PinOutput(GPIONum num, Reconfigure tag) noexcept : GPIO(num, tag) {}
+
+        friend class PinInput;
+        friend class PinOutputInput;
     };
 
     /**
@@ -267,6 +396,47 @@ namespace Components
         void setPullMode(GPIOPullMode mode);
         void wakeupEnable(GPIOWakeupIntrType interrupt_type);
         void wakeupDisable();
+
+        /**
+         * @brief Call \c handler from ISR context whenever the pin triggers according to \c type.
+         *
+         * The shared GPIO ISR service is installed on first use.
+         *
+         * @throws GPIOException
+         *              - if the underlying driver function fails
+         */
+        void interruptEnable(GPIOIntrType type, GPIOISRHandler handler, void *arg);
+        void interruptDisable();
+
+        /**
+         * @brief Turn this input into an output driving \c level without resetting the pin.
+         *
+         * The level is latched before the output is enabled, so the pin never glitches to another level.
+         * Only the direction is changed, the pull and drive configuration is kept.
+         * The object is consumed, don't use it afterwards.
+         *
+         * @throws GPIOException
+         *              - if the underlying driver function fails
+         */
+        PinOutput intoOutput(GPIOLevel level) &&;
+
+        /**
+         * @brief Turn this input into an open drain output and input without resetting the pin.
+         *
+         * The pin stays released (floating) after the transition.
+         * The object is consumed, don't use it afterwards.
+         *
+         * @throws GPIOException
+         *              - if the underlying driver function fails
+         */
+        PinOutputInput intoOutputInput() &&;
+
+    protected:
+        PinInput(GPIONum num, Reconfigure tag) noexcept : GPIO(num, tag) {}
+
+    private:
+        friend class PinOutput;
+        friend class PinOutputInput;
     };
 
     /**
@@ -289,8 +459,34 @@ namespace Components
         void setFloating();
         void setLow();
 
+        /**
+         * @brief Turn this pin into a plain input without resetting it.
+         *
+         * The object is consumed, don't use it afterwards.
+         *
+         * @throws GPIOException
+         *              - if the underlying driver function fails
+         */
+        PinInput intoInput() &&;
+
+        /**
+         * @brief Turn this pin into a push pull output driving \c level without resetting it.
+         *
+         * The object is consumed, don't use it afterwards.
+         *
+         * @throws GPIOException
+         *              - if the underlying driver function fails
+         */
+        PinOutput intoOutput(GPIOLevel level) &&;
+
         using GPIO::getDriveStrength;
         using GPIO::setDriveStrength;
+
+    private:
+        PinOutputInput(GPIONum num, Reconfigure tag) noexcept : PinInput(num, tag) {}
+
+        friend class PinInput;
+        friend class PinOutput;
     };
 
 }
@@ -0,0 +1,245 @@
+#pragma once
+
+#if __cpp_exceptions
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include "GpioMask.hpp"
+#if CONFIG_IDF_TARGET_LINUX
+#include "SimulatedGpio.hpp"
+#else
+#include "soc/gpio_reg.h"
+#include "soc/soc.h"
+#include "soc/soc_caps.h"
+#endif
+
+/**
+ * Forces the register primitives inline, so IRAM callers (ISRs, \c SafeState::apply()) never call into flash, even
+ * at optimization levels which would emit plain inline functions out of line.
+ */
+#define GPIO_BANKS_INLINE __attribute__((always_inline)) inline
+
+namespace Components
+{
+    /**
+     * @brief Bank aware access to the GPIO output and input registers for multi pin operations.
+     *
+     * Chips with more than 32 GPIOs (ESP32, ESP32-S3) keep the upper pins in a second set of registers. The
+     * functions here split a \c GpioMask per bank and only store to the registers of banks which have bits set.
+     * Everything is forced inline, so with constant masks the unnecessary stores are removed by the compiler; the
+     * template versions guarantee this. It also makes the functions safe to call from IRAM code while the flash
+     * cache is disabled.
+     *
+     * Sets are stored before clears and bank 0 before bank 1. On the Linux target, \c SimulatedGpioRegisters
+     * is used instead of hardware registers.
+     *
+     * These functions bypass the driver, the pins are expected to be configured already (e.g. by \c PinOutput).
+     */
+    namespace GpioBanks
+    {
+        constexpr size_t BANK_COUNT = GpioMask::BANK_COUNT;
+
+#if !CONFIG_IDF_TARGET_LINUX
+        GPIO_BANKS_INLINE constexpr uint32_t setRegister(size_t bank) noexcept
+        {
+#if SOC_GPIO_PIN_COUNT > 32
+            return bank == 0 ? GPIO_OUT_W1TS_REG : GPIO_OUT1_W1TS_REG;
+#else
+            return (void)bank, GPIO_OUT_W1TS_REG;
+#endif
+        }
+
+        GPIO_BANKS_INLINE constexpr uint32_t clearRegister(size_t bank) noexcept
+        {
+#if SOC_GPIO_PIN_COUNT > 32
+            return bank == 0 ? GPIO_OUT_W1TC_REG : GPIO_OUT1_W1TC_REG;
+#else
+            return (void)bank, GPIO_OUT_W1TC_REG;
+#endif
+        }
+
+        GPIO_BANKS_INLINE constexpr uint32_t outputRegister(size_t bank) noexcept
+        {
+#if SOC_GPIO_PIN_COUNT > 32
+            return bank == 0 ? GPIO_OUT_REG : GPIO_OUT1_REG;
+#else
+            return (void)bank, GPIO_OUT_REG;
+#endif
+        }
+
+        GPIO_BANKS_INLINE constexpr uint32_t enableRegister(size_t bank) noexcept
+        {
+#if SOC_GPIO_PIN_COUNT > 32
+            return bank == 0 ? GPIO_ENABLE_REG : GPIO_ENABLE1_REG;
+#else
+            return (void)bank, GPIO_ENABLE_REG;
+#endif
+        }
+
+        GPIO_BANKS_INLINE constexpr uint32_t inputRegister(size_t bank) noexcept
+        {
+#if SOC_GPIO_PIN_COUNT > 32
+            return bank == 0 ? GPIO_IN_REG : GPIO_IN1_REG;
+#else
+            return (void)bank, GPIO_IN_REG;
+#endif
+        }
+#endif
+
+        /**
+         * @brief Store \c set and \c clear to the output registers of \c bank, skipping zero masks.
+         */
+        GPIO_BANKS_INLINE void writeBank(size_t bank, uint32_t set, uint32_t clear) noexcept
+        {
+#if CONFIG_IDF_TARGET_LINUX
+            SimulatedGpioRegisters::instance().write(bank, set, clear);
+#else
+            if (set)
+            {
+                REG_WRITE(setRegister(bank), set);
+            }
+            if (clear)
+            {
+                REG_WRITE(clearRegister(bank), clear);
+            }
+#endif
+        }
+
+        /**
+         * @brief Replace the output levels of the pins in \c mask of \c bank with one store to the output register.
+         *
+         * This is a read-modify-write of the whole bank, the caller has to make sure no other output of the bank
+         * is changed concurrently.
+         */
+        GPIO_BANKS_INLINE void assignBank(size_t bank, uint32_t mask, uint32_t levels) noexcept
+        {
+#if CONFIG_IDF_TARGET_LINUX
+            SimulatedGpioRegisters &registers = SimulatedGpioRegisters::instance();
+            registers.writeOutput(bank, (registers.readOutput(bank) & ~mask) | (levels & mask));
+#else
+            REG_WRITE(outputRegister(bank), (REG_READ(outputRegister(bank)) & ~mask) | (levels & mask));
+#endif
+        }
+
+        /**
+         * @brief The input levels of all pins of \c bank.
+         */
+        GPIO_BANKS_INLINE uint32_t readBank(size_t bank) noexcept
+        {
+#if CONFIG_IDF_TARGET_LINUX
+            return SimulatedGpioRegisters::instance().readInput(bank);
+#else
+            return REG_READ(inputRegister(bank));
+#endif
+        }
+
+        /**
+         * @brief The output latch of all pins of \c bank.
+         */
+        GPIO_BANKS_INLINE uint32_t readOutputBank(size_t bank) noexcept
+        {
+#if CONFIG_IDF_TARGET_LINUX
+            return SimulatedGpioRegisters::instance().readOutput(bank);
+#else
+            return REG_READ(outputRegister(bank));
+#endif
+        }
+
+        /**
+         * @brief The output enable bits of all pins of \c bank.
+         */
+        GPIO_BANKS_INLINE uint32_t readEnableBank(size_t bank) noexcept
+        {
+#if CONFIG_IDF_TARGET_LINUX
+            return SimulatedGpioRegisters::instance().getOutputEnable(bank);
+#else
+            return REG_READ(enableRegister(bank));
+#endif
+        }
+
+        /**
+         * @brief Drive the pins in \c set high and the pins in \c clear low.
+         */
+        GPIO_BANKS_INLINE void write(const GpioMask &set, const GpioMask &clear) noexcept
+        {
+            for (size_t bank = 0; bank < BANK_COUNT; bank++)
+            {
+                writeBank(bank, set.banks[bank], clear.banks[bank]);
+            }
+        }
+
+        GPIO_BANKS_INLINE void setHigh(const GpioMask &pins) noexcept
+        {
+            write(pins, GpioMask());
+        }
+
+        GPIO_BANKS_INLINE void setLow(const GpioMask &pins) noexcept
+        {
+            write(GpioMask(), pins);
+        }
+
+        /**
+         * @brief Drive the pins in \c pins to the corresponding bits of \c levels with at most two stores per bank.
+         */
+        GPIO_BANKS_INLINE void assign(const GpioMask &pins, const GpioMask &levels) noexcept
+        {
+            write(pins & levels, pins - levels);
+        }
+
+        /**
+         * @brief The input levels of the pins in \c pins, reading only banks which contain any of them.
+         */
+        GPIO_BANKS_INLINE GpioMask read(const GpioMask &pins = GpioMask::valid()) noexcept
+        {
+            GpioMask levels;
+            for (size_t bank = 0; bank < BANK_COUNT; bank++)
+            {
+                if (pins.banks[bank])
+                {
+                    levels.banks[bank] = readBank(bank) & pins.banks[bank];
+                }
+            }
+            return levels;
+        }
+
+        /**
+         * @brief Stores of one bank with constant masks, zero masks generate no code.
+         */
+        template <size_t BANK, uint32_t SET, uint32_t CLEAR>
+        GPIO_BANKS_INLINE void writeBank() noexcept
+        {
+            if constexpr (SET != 0 || CLEAR != 0)
+            {
+                writeBank(BANK, SET, CLEAR);
+            }
+        }
+
+        /**
+         * @brief Compile time split of \c write(), only banks with non zero masks generate stores.
+         */
+        template <GpioMask SET, GpioMask CLEAR = GpioMask()>
+        GPIO_BANKS_INLINE void write() noexcept
+        {
+            [&]<size_t... BANK>(std::index_sequence<BANK...>) {
+                (writeBank<BANK, SET.banks[BANK], CLEAR.banks[BANK]>(), ...);
+            }(std::make_index_sequence<BANK_COUNT>());
+        }
+
+        /**
+         * @brief Compile time split of \c read(), only banks with pins in \c PINS are read.
+         */
+        template <GpioMask PINS>
+        GPIO_BANKS_INLINE GpioMask read() noexcept
+        {
+            GpioMask levels;
+            [&]<size_t... BANK>(std::index_sequence<BANK...>) {
+                ((levels.banks[BANK] = PINS.banks[BANK] ? readBank(BANK) & PINS.banks[BANK] : 0), ...);
+            }(std::make_index_sequence<BANK_COUNT>());
+            return levels;
+        }
+    }
+
+}
+
+#endif
@@ -0,0 +1,122 @@
+#pragma once
+
+#if __cpp_exceptions
+
+#include <cstddef>
+#include <cstdint>
+#include "sdkconfig.h"
+
+namespace Components
+{
+    /**
+     * @brief Time source used by all timing related GPIO functionality (timestamps, latency measurement, etc.).
+     *
+     * On the Linux target, the clock can be switched to virtual time, which only moves when advanced. Timestamps,
+     * delays and the virtual timers driving \c GestureEngine and \c HeartbeatOutput then follow the virtual time,
+     * so tests spanning hours of device time run in milliseconds. The virtual clock is not thread safe, it is
+     * meant to be driven by a single test thread.
+     */
+    namespace GpioClock
+    {
+        /**
+         * @brief Monotonic time in microseconds since boot.
+         *
+         * Safe to call from ISR context.
+         */
+        int64_t nowUs() noexcept;
+
+        /**
+         * @brief Free running cycle counter of the calling core for short measurements.
+         *
+         * On the Linux target, which has no cycle counter, this counts nanoseconds instead.
+         */
+        uint32_t cycles() noexcept;
+
+        /**
+         * @brief Index of the CPU core the caller is running on.
+         */
+        uint32_t coreId() noexcept;
+
+        /**
+         * @brief Busy wait for \c us microseconds.
+         *
+         * In virtual time on the Linux target, this advances the clock instead. Timers which become due fire on the
+         * next \c advanceNs().
+         */
+        void delayUs(uint32_t us) noexcept;
+
+        /**
+         * @brief Number of CPU cores on the current hardware.
+         */
+        constexpr uint32_t CORE_COUNT =
+#if CONFIG_IDF_TARGET_ESP32 || CONFIG_IDF_TARGET_ESP32S3
+            2;
+#else
+            1;
+#endif
+
+#if CONFIG_IDF_TARGET_LINUX
+        using TimerCallback = void (*)(void *arg);
+
+        constexpr size_t MAX_VIRTUAL_TIMERS = 8;
+
+        /**
+         * @brief Switch between virtual and real time. Virtual time continues from the current real time.
+         */
+        void setVirtual(bool enable) noexcept;
+
+        bool isVirtual() noexcept;
+
+        /**
+         * @brief Like \c nowUs(), in nanoseconds, for simulations needing sub-microsecond timing.
+         */
+        uint64_t nowNs() noexcept;
+
+        /**
+         * @brief Move the virtual time forward by \c ns, firing the timers which become due on the way, each at its
+         * own due time.
+         */
+        void advanceNs(uint64_t ns);
+
+        inline void advanceUs(uint64_t us)
+        {
+            advanceNs(us * 1000);
+        }
+
+        /**
+         * @brief Move the virtual time forward by \c ns without firing timers, as delays do.
+         */
+        void skipNs(uint64_t ns) noexcept;
+
+        /**
+         * @brief Jump to the next due timer and fire it, to run as fast as events allow.
+         *
+         * @return false if no timer is running.
+         */
+        bool runNextTimer();
+
+        /**
+         * @brief Advance the virtual time by \c ns on every \c nowUs() and \c cycles() call, so busy wait loops
+         * polling the clock terminate. 0 (the default) disables it.
+         */
+        void setAutoAdvanceNs(uint32_t ns) noexcept;
+
+        /**
+         * @brief Call \c callback every \c period_us of virtual time. Timers never fire in real time.
+         *
+         * Callbacks are not nested: timers becoming due while a callback advances the clock fire after it returned.
+         *
+         * @return the timer id for \c stopTimer().
+         *
+         * @throws GPIOException
+         *              - with ESP_ERR_NO_MEM if \c MAX_VIRTUAL_TIMERS timers are running
+         *              - with ESP_ERR_INVALID_ARG if \c period_us is 0
+         */
+        int startTimer(TimerCallback callback, void *arg, uint64_t period_us);
+
+        void stopTimer(int timer) noexcept;
+#endif
+    }
+}
+
+#endif
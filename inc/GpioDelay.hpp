@@ -0,0 +1,79 @@
+#pragma once
+
+#if __cpp_exceptions
+
+#include <cstddef>
+#include <cstdint>
+#include "GpioLatency.hpp"
+#include "PinConcepts.hpp"
+
+namespace Components
+{
+    /**
+     * @brief Busy wait delays with sub-microsecond resolution for bit-banging.
+     *
+     * The delays poll the cycle counter instead of counting loop iterations, so they don't depend on cache state or
+     * on where the calling code runs from. \c calibrate() measures the CPU cycles per microsecond against esp_timer
+     * and the fixed overhead of a delay call, which is subtracted from every delay. When the CPU frequency changes
+     * (e.g. through dynamic frequency scaling), the cycle rate is rescaled on the next delay.
+     *
+     * All delays are IRAM resident and can be used from ISRs and with the flash cache disabled. They don't yield,
+     * interrupts during a delay lengthen it.
+     */
+    namespace GpioDelay
+    {
+        /**
+         * @brief Measure the cycle rate and the call overhead. Takes about one millisecond.
+         *
+         * Called automatically before the first delay if it wasn't called before. Call it during startup if delays
+         * are used from ISRs or with the flash cache disabled, as the calibration itself is not IRAM resident.
+         */
+        void calibrate() noexcept;
+
+        /**
+         * @brief CPU cycles per microsecond (1000 on Linux, where the cycle counter counts nanoseconds).
+         */
+        uint32_t cyclesPerUs() noexcept;
+
+        /**
+         * @brief Cycles taken by a delay call besides the waiting.
+         */
+        uint32_t overheadCycles() noexcept;
+
+        /**
+         * @brief Busy wait for \c cycles CPU cycles, including the call itself.
+         *
+         * Delays shorter than the call overhead return immediately.
+         */
+        void delayCycles(uint32_t cycles) noexcept;
+
+        /**
+         * @brief Busy wait for \c ns nanoseconds, rounded down to whole CPU cycles.
+         */
+        void delayNs(uint32_t ns) noexcept;
+
+        /**
+         * @brief Run \c delayNs(ns) \c iterations times and record the absolute error of each run in nanoseconds.
+         *
+         * \c errors is used with nanoseconds, so its percentiles are in nanoseconds and errors above
+         * \c LatencyHistogram::MAX_VALUE (about one millisecond) are counted in its last bucket.
+         */
+        void measureAccuracy(uint32_t ns, size_t iterations, LatencyHistogram &errors) noexcept;
+
+        /**
+         * @brief Pull an open drain \c pin low for \c ns nanoseconds and release it, e.g. for 1-Wire time slots.
+         *
+         * The CPU is kept at its maximum frequency during the pulse.
+         */
+        template <OpenDrainPin Pin>
+        inline void pulseLow(Pin &pin, uint32_t ns)
+        {
+            GpioPowerGuard guard;
+            pin.setLow();
+            delayNs(ns);
+            pin.setFloating();
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,79 @@
+#pragma once
+
+#if __cpp_exceptions
+
+#include <cstddef>
+#include <cstdint>
+#include "Gpio.hpp"
+#include "GpioMask.hpp"
+
+namespace Components
+{
+    /**
+     * @brief Direction of a pin as configured in the GPIO matrix and IO MUX.
+     */
+    enum class GPIODirection : uint8_t
+    {
+        DISABLED,
+        INPUT,
+        OUTPUT,
+        INPUT_OUTPUT,
+    };
+
+    /**
+     * @brief Decoded configuration and state of one pin, four bytes per pin.
+     */
+    struct GPIOPinState
+    {
+        uint32_t num : 6;
+        uint32_t direction : 2;     ///< a \c GPIODirection
+        uint32_t open_drain : 1;
+        uint32_t input_level : 1;
+        uint32_t output_level : 1;  ///< the output latch, also valid while the output is disabled
+        uint32_t pull_up : 1;
+        uint32_t pull_down : 1;
+        uint32_t drive : 2;         ///< a \c GPIODriveStrength value
+        uint32_t hold : 1;          ///< as set with \c GPIO::holdEnable()
+        uint32_t function : 3;      ///< IO MUX function, the GPIO matrix is function 1 on ESP32, otherwise 1 or 2
+        uint32_t intr_type : 3;     ///< a \c GPIOIntrType value, 0 if disabled
+        uint32_t out_signal : 9;    ///< GPIO matrix output signal index
+
+        GPIODirection getDirection() const noexcept
+        {
+            return static_cast<GPIODirection>(direction);
+        }
+    };
+
+    static_assert(sizeof(GPIOPinState) == 4);
+
+    /**
+     * @brief Reads the configuration of many pins at once, e.g. for debugging or periodic telemetry.
+     *
+     * The output, enable and input registers are read once per bank, the per pin registers (IO MUX, GPIO pin
+     * and output signal selection) once per pin. Pull and drive of RTC IO pads come from their RTC IO register.
+     * No driver functions are called and nothing is allocated. Pin numbers without a pad are skipped.
+     *
+     * On the Linux target, only direction and levels are known, all other fields are zero.
+     */
+    namespace GpioDiagnostics
+    {
+        /**
+         * @brief Read the state of the valid pins in \c pins, in ascending order.
+         *
+         * @return the number of states written, at most \c max_states.
+         */
+        size_t snapshot(GPIOPinState *states, size_t max_states, const GpioMask &pins = GpioMask::valid()) noexcept;
+
+        /**
+         * @brief Write one human readable line for \c state to \c buffer, like snprintf.
+         */
+        int format(const GPIOPinState &state, char *buffer, size_t size) noexcept;
+
+        /**
+         * @brief Keep track of the hold state for the \c hold field, called by \c GPIO.
+         */
+        void noteHold(uint32_t pin, bool enabled) noexcept;
+    }
+}
+
+#endif
@@ -0,0 +1,162 @@
+#pragma once
+
+#if __cpp_exceptions
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "Gpio.hpp"
+#include "GpioClock.hpp"
+
+namespace Components
+{
+    /**
+     * @brief Fixed size logarithmic histogram of latencies.
+     *
+     * Every power of two is split into \c SUB_BUCKETS linear buckets, so the relative error of any reported value is
+     * below 1 / \c SUB_BUCKETS. Values above \c MAX_VALUE are counted in the last bucket.
+     *
+     * The buckets don't depend on the unit, queries return the unit which was recorded. The interrupt latency
+     * probes record microseconds, \c GpioDelay::measureAccuracy() records nanoseconds, where \c MAX_VALUE is
+     * about one millisecond.
+     * Recording is lock free and allocation free, hence it may be done from ISR context.
+     */
+    class LatencyHistogram
+    {
+    public:
+        static constexpr uint32_t SUB_BUCKET_BITS = 2;
+        static constexpr uint32_t SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+        static constexpr uint32_t MAX_VALUE_BITS = 20;
+        static constexpr uint32_t MAX_VALUE = (1u << MAX_VALUE_BITS) - 1;
+        static constexpr uint32_t MAX_VALUE_US = MAX_VALUE; ///< \c MAX_VALUE when recording microseconds
+        static constexpr size_t BUCKET_COUNT = (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+        LatencyHistogram() noexcept;
+
+        /**
+         * @brief Count one sample of \c latency, microseconds unless documented otherwise by the recorder.
+         */
+        void record(uint32_t latency) noexcept;
+
+        /**
+         * @brief Add all samples of \c other to this histogram.
+         */
+        void merge(const LatencyHistogram &other) noexcept;
+
+        void reset() noexcept;
+
+        /**
+         * @brief Number of recorded samples.
+         */
+        uint32_t count() const noexcept;
+
+        /**
+         * @brief Upper bound of the latency below which \c percent percent of the samples lie, in the recorded unit.
+         *
+         * @param percent value between 0 and 100.
+         * @return 0 if no samples were recorded.
+         */
+        uint32_t percentile(float percent) const noexcept;
+
+        /**
+         * @brief Map a latency to its bucket index.
+         */
+        static constexpr size_t bucketOf(uint32_t latency) noexcept
+        {
+            if (latency > MAX_VALUE)
+            {
+                latency = MAX_VALUE;
+            }
+            if (latency < SUB_BUCKETS)
+            {
+                return latency;
+            }
+            uint32_t msb = 31 - __builtin_clz(latency);
+            uint32_t sub = (latency >> (msb - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+            return (msb - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub;
+        }
+
+        /**
+         * @brief Largest latency which is mapped to bucket \c index.
+         */
+        static constexpr uint32_t upperBoundOf(size_t index) noexcept
+        {
+            if (index < SUB_BUCKETS)
+            {
+                return index;
+            }
+            uint32_t msb = index / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+            uint32_t sub = index % SUB_BUCKETS;
+            uint32_t width = 1u << (msb - SUB_BUCKET_BITS);
+            return (1u << msb) + (sub + 1) * width - 1;
+        }
+
+    private:
+        std::array<std::atomic<uint32_t>, BUCKET_COUNT> buckets;
+    };
+
+    /**
+     * @brief Measures the time between a GPIO interrupt and the moment its event is handled.
+     *
+     * The probe installs itself as the interrupt handler of a \c PinInput, takes a timestamp at ISR entry and then
+     * forwards to the user handler. Whoever finally handles the event (the ISR handler itself or a task it woke up)
+     * calls \c dispatched(), which records the elapsed time into a histogram of the calling core.
+     * Keeping one histogram per core avoids cross-core contention on the buckets; queries merge them.
+     *
+     * Probes keep no heap memory, they are meant to be placed in static storage next to the pin they monitor.
+     */
+    class InterruptLatencyProbe
+    {
+    public:
+        InterruptLatencyProbe() noexcept;
+
+        InterruptLatencyProbe(const InterruptLatencyProbe &) = delete;
+        InterruptLatencyProbe &operator=(const InterruptLatencyProbe &) = delete;
+
+        /**
+         * @brief Enable the interrupt of \c pin with the probe in front of \c handler.
+         *
+         * @throws GPIOException
+         *              - if the underlying driver function fails
+         */
+        void attach(PinInput &pin, GPIOIntrType type, GPIOISRHandler handler, void *arg);
+
+        /**
+         * @brief Take the ISR entry timestamp. Only needed when not using \c attach().
+         */
+        void isrEntry() noexcept;
+
+        /**
+         * @brief Record the latency since the last ISR entry. Safe to call from ISR and task context.
+         *
+         * Calls without a pending ISR entry are ignored, so only the first dispatch of an interrupt is counted.
+         */
+        void dispatched() noexcept;
+
+        /**
+         * @brief Merge the histograms of all cores into \c result.
+         */
+        void snapshot(LatencyHistogram &result) const noexcept;
+
+        /**
+         * @brief Shortcut for a percentile query over all cores, see \c LatencyHistogram::percentile().
+         */
+        uint32_t percentile(float percent) const noexcept;
+
+        void reset() noexcept;
+
+    private:
+        static void isrTrampoline(void *arg);
+
+        static constexpr int64_t NO_PENDING_ENTRY = -1;
+
+        GPIOISRHandler handler;
+        void *handler_arg;
+        std::atomic<int64_t> entry_us;
+        std::array<LatencyHistogram, GpioClock::CORE_COUNT> per_core;
+    };
+
+}
+
+#endif
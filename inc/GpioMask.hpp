@@ -0,0 +1,321 @@
+#pragma once
+
+#if __cpp_exceptions
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include "driver/gpio.h"
+#include "Gpio.hpp"
+
+namespace Components
+{
+    /**
+     * @brief Pin numbers below GPIO_NUM_MAX which don't exist on the current hardware.
+     */
+#if CONFIG_IDF_TARGET_LINUX
+    inline constexpr std::array<uint32_t, 5> INVALID_GPIOS = {24, 28, 29, 30, 31};
+#elif CONFIG_IDF_TARGET_ESP32
+    inline constexpr std::array<uint32_t, 5> INVALID_GPIOS = {24, 28, 29, 30, 31};
+#elif CONFIG_IDF_TARGET_ESP32S2
+    inline constexpr std::array<uint32_t, 4> INVALID_GPIOS = {22, 23, 24, 25};
+#elif CONFIG_IDF_TARGET_ESP32S3
+    inline constexpr std::array<uint32_t, 4> INVALID_GPIOS = {22, 23, 24, 25};
+#elif CONFIG_IDF_TARGET_ESP32C3
+    inline constexpr std::array<uint32_t, 0> INVALID_GPIOS = {};
+#elif CONFIG_IDF_TARGET_ESP32C2
+    inline constexpr std::array<uint32_t, 0> INVALID_GPIOS = {};
+#else
+#error "No GPIOs defined for the current target"
+#endif
+
+    /**
+     * @brief Compile time version of \c isValidPin().
+     */
+    constexpr bool isValidPinConstexpr(uint32_t pin_num) noexcept
+    {
+        if (pin_num >= GPIO_NUM_MAX)
+        {
+            return false;
+        }
+
+        for (auto num : INVALID_GPIOS)
+        {
+            if (pin_num == num)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief A set of GPIO pins, one bit per pin, laid out like the chip's GPIO register banks.
+     *
+     * Bank 0 holds GPIO 0 to 31 (e.g. GPIO_OUT_REG), bank 1 holds GPIO 32 and up (e.g. GPIO_OUT1_REG) on chips
+     * which have them. All operations are constexpr, so masks of constant pins cost nothing at runtime.
+     *
+     * The bank array is public to make \c GpioMask usable as a template argument, prefer the member functions.
+     */
+    class GpioMask
+    {
+    public:
+        static constexpr size_t BANK_BITS = 32;
+        static constexpr size_t BANK_COUNT = (GPIO_NUM_MAX + BANK_BITS - 1) / BANK_BITS;
+
+        /**
+         * @brief Iterates over the pin numbers in a mask in ascending order using count trailing zeros.
+         */
+        class Iterator
+        {
+        public:
+            constexpr Iterator(const GpioMask &mask, size_t bank) noexcept
+                : mask(&mask), bank(bank), remaining(bank < BANK_COUNT ? mask.banks[bank] : 0)
+            {
+                skipEmptyBanks();
+            }
+
+            constexpr uint32_t operator*() const noexcept
+            {
+                return static_cast<uint32_t>(bank * BANK_BITS + __builtin_ctz(remaining));
+            }
+
+            constexpr Iterator &operator++() noexcept
+            {
+                remaining &= remaining - 1;
+                skipEmptyBanks();
+                return *this;
+            }
+
+            constexpr bool operator==(const Iterator &other) const noexcept
+            {
+                return bank == other.bank && remaining == other.remaining;
+            }
+
+            constexpr bool operator!=(const Iterator &other) const noexcept
+            {
+                return !(*this == other);
+            }
+
+        private:
+            constexpr void skipEmptyBanks() noexcept
+            {
+                while (remaining == 0 && bank < BANK_COUNT)
+                {
+                    bank++;
+                    remaining = bank < BANK_COUNT ? mask->banks[bank] : 0;
+                }
+            }
+
+            const GpioMask *mask;
+            size_t bank;
+            uint32_t remaining;
+        };
+
+        constexpr GpioMask() noexcept : banks{} {}
+
+        /**
+         * @brief Create a mask from already validated pin numbers.
+         */
+        GpioMask(std::initializer_list<GPIONum> pins) noexcept : banks{}
+        {
+            for (const auto &pin : pins)
+            {
+                set(pin.get_value<uint32_t>());
+            }
+        }
+
+        /**
+         * @brief Create a mask from raw pin numbers.
+         *
+         * In a constant expression, an invalid pin number is a compile error.
+         *
+         * @throws GPIOException
+         *              - with ESP_ERR_INVALID_ARG if a pin number is not valid on the current hardware
+         */
+        static constexpr GpioMask fromPins(std::initializer_list<uint32_t> pins)
+        {
+            GpioMask mask;
+            for (uint32_t pin : pins)
+            {
+                if (!isValidPinConstexpr(pin))
+                {
+                    throw GPIOException(ESP_ERR_INVALID_ARG);
+                }
+                mask.set(pin);
+            }
+            return mask;
+        }
+
+        /**
+         * @brief Create a mask from a 64 bit value, bit n meaning GPIO n. Bits of invalid pins are dropped.
+         */
+        static constexpr GpioMask fromBits(uint64_t bits) noexcept
+        {
+            GpioMask mask;
+            for (size_t bank = 0; bank < BANK_COUNT; bank++)
+            {
+                mask.banks[bank] = static_cast<uint32_t>(bits >> (bank * BANK_BITS));
+            }
+            return mask & valid();
+        }
+
+        /**
+         * @brief The mask of all pins which exist on the current hardware.
+         */
+        static constexpr GpioMask valid() noexcept
+        {
+            GpioMask mask;
+            for (uint32_t pin = 0; pin < GPIO_NUM_MAX; pin++)
+            {
+                if (isValidPinConstexpr(pin))
+                {
+                    mask.set(pin);
+                }
+            }
+            return mask;
+        }
+
+        constexpr void set(uint32_t pin) noexcept
+        {
+            banks[pin / BANK_BITS] |= 1u << (pin % BANK_BITS);
+        }
+
+        constexpr void reset(uint32_t pin) noexcept
+        {
+            banks[pin / BANK_BITS] &= ~(1u << (pin % BANK_BITS));
+        }
+
+        constexpr bool contains(uint32_t pin) const noexcept
+        {
+            return pin < GPIO_NUM_MAX && ((banks[pin / BANK_BITS] >> (pin % BANK_BITS)) & 1);
+        }
+
+        /**
+         * @brief The register value of \c bank, e.g. bank 1 is what goes into GPIO_OUT1_W1TS_REG.
+         */
+        constexpr uint32_t getBank(size_t bank) const noexcept
+        {
+            return bank < BANK_COUNT ? banks[bank] : 0;
+        }
+
+        constexpr uint32_t getLow() const noexcept
+        {
+            return getBank(0);
+        }
+
+        constexpr uint32_t getHigh() const noexcept
+        {
+            return getBank(1);
+        }
+
+        /**
+         * @brief The mask as 64 bit value, bit n meaning GPIO n, as e.g. used by gpio_config_t.
+         */
+        constexpr uint64_t toBits() const noexcept
+        {
+            return static_cast<uint64_t>(getLow()) | (static_cast<uint64_t>(getHigh()) << BANK_BITS);
+        }
+
+        constexpr size_t count() const noexcept
+        {
+            size_t total = 0;
+            for (auto bank : banks)
+            {
+                total += __builtin_popcount(bank);
+            }
+            return total;
+        }
+
+        constexpr bool empty() const noexcept
+        {
+            for (auto bank : banks)
+            {
+                if (bank)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        constexpr Iterator begin() const noexcept
+        {
+            return Iterator(*this, 0);
+        }
+
+        constexpr Iterator end() const noexcept
+        {
+            return Iterator(*this, BANK_COUNT);
+        }
+
+        constexpr GpioMask &operator|=(const GpioMask &other) noexcept
+        {
+            for (size_t i = 0; i < BANK_COUNT; i++)
+            {
+                banks[i] |= other.banks[i];
+            }
+            return *this;
+        }
+
+        constexpr GpioMask &operator&=(const GpioMask &other) noexcept
+        {
+            for (size_t i = 0; i < BANK_COUNT; i++)
+            {
+                banks[i] &= other.banks[i];
+            }
+            return *this;
+        }
+
+        /**
+         * @brief Set difference, removes all pins of \c other.
+         */
+        constexpr GpioMask &operator-=(const GpioMask &other) noexcept
+        {
+            for (size_t i = 0; i < BANK_COUNT; i++)
+            {
+                banks[i] &= ~other.banks[i];
+            }
+            return *this;
+        }
+
+        friend constexpr GpioMask operator|(GpioMask lhs, const GpioMask &rhs) noexcept
+        {
+            return lhs |= rhs;
+        }
+
+        friend constexpr GpioMask operator&(GpioMask lhs, const GpioMask &rhs) noexcept
+        {
+            return lhs &= rhs;
+        }
+
+        friend constexpr GpioMask operator-(GpioMask lhs, const GpioMask &rhs) noexcept
+        {
+            return lhs -= rhs;
+        }
+
+        friend constexpr bool operator==(const GpioMask &lhs, const GpioMask &rhs) noexcept
+        {
+            for (size_t i = 0; i < BANK_COUNT; i++)
+            {
+                if (lhs.banks[i] != rhs.banks[i])
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        friend constexpr bool operator!=(const GpioMask &lhs, const GpioMask &rhs) noexcept
+        {
+            return !(lhs == rhs);
+        }
+
+        std::array<uint32_t, BANK_COUNT> banks;
+    };
+
+}
+
+#endif
@@ -0,0 +1,78 @@
+#pragma once
+
+#if __cpp_exceptions
+
+#include <cstdint>
+#include "Gpio.hpp"
+
+struct esp_pm_lock;
+
+namespace Components
+{
+    /**
+     * @brief Keeps the CPU at its maximum frequency while timing critical GPIO code runs.
+     *
+     * With dynamic frequency scaling enabled, the CPU clock may drop while a bit-banged transfer or a busy loop
+     * capture is running, which changes their timing and the interrupt latency. The engines of this component
+     * acquire the shared \c timing() lock only for the duration of a transfer, so the frequency can drop again
+     * as soon as they are idle.
+     *
+     * The lock is counting, every \c acquire() needs a matching \c release(). Without CONFIG_PM_ENABLE and on the
+     * Linux target, acquiring and releasing does nothing.
+     */
+    class GpioPowerLock
+    {
+    public:
+        /**
+         * @brief The lock shared by all timing critical engines. Create it before the first use from an ISR.
+         *
+         * @throws GPIOException
+         *              - if the underlying driver function fails on first use
+         */
+        static GpioPowerLock &timing();
+
+        GpioPowerLock(const GpioPowerLock &) = delete;
+        GpioPowerLock &operator=(const GpioPowerLock &) = delete;
+
+        /**
+         * @brief Request the maximum CPU frequency. IRAM resident, may be called from ISRs.
+         */
+        void acquire() noexcept;
+
+        /**
+         * @brief Drop one request for the maximum CPU frequency. IRAM resident, may be called from ISRs.
+         */
+        void release() noexcept;
+
+    private:
+        explicit GpioPowerLock(const char *name);
+
+        esp_pm_lock *handle;
+    };
+
+    /**
+     * @brief Holds a \c GpioPowerLock for the lifetime of the guard.
+     */
+    class GpioPowerGuard
+    {
+    public:
+        explicit GpioPowerGuard(GpioPowerLock &lock = GpioPowerLock::timing()) noexcept : lock(lock)
+        {
+            lock.acquire();
+        }
+
+        ~GpioPowerGuard()
+        {
+            lock.release();
+        }
+
+        GpioPowerGuard(const GpioPowerGuard &) = delete;
+        GpioPowerGuard &operator=(const GpioPowerGuard &) = delete;
+
+    private:
+        GpioPowerLock &lock;
+    };
+
+}
+
+#endif
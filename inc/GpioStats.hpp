@@ -0,0 +1,60 @@
+#pragma once
+
+#if __cpp_exceptions
+
+#include <cstdint>
+
+/**
+ * Per pin usage counters, updated by the GPIO classes. Define as 0 to remove the counting from all hot paths.
+ */
+#ifndef GPIO_STATS_ENABLE
+#define GPIO_STATS_ENABLE 1
+#endif
+
+namespace Components
+{
+    /**
+     * @brief Usage counters of one pin.
+     */
+    struct GpioPinCounters
+    {
+        /**
+         * @brief Level writes by \c PinOutput and \c PinOutputInput.
+         */
+        uint32_t writes;
+
+        /**
+         * @brief Writes which changed the level written before.
+         */
+        uint32_t toggles;
+
+        /**
+         * @brief Interrupts dispatched to handlers installed with \c PinInput::interruptEnable().
+         */
+        uint32_t interrupts;
+    };
+
+    /**
+     * @brief Process wide GPIO usage counters, e.g. for fleet health telemetry (\c GpioTelemetry).
+     *
+     * The counters wrap around at 2^32, consumers should only look at differences. All functions are IRAM
+     * resident and lock free. Writes done directly on the registers (\c GpioBanks, fast pins) are not counted.
+     */
+    namespace GpioStats
+    {
+        void countWrite(uint32_t pin, bool level) noexcept;
+        void countInterrupt(uint32_t pin) noexcept;
+
+        /**
+         * @brief Count a failed driver call, done for every \c GPIOException.
+         */
+        void countError() noexcept;
+
+        GpioPinCounters read(uint32_t pin) noexcept;
+        uint32_t errors() noexcept;
+
+        void clear() noexcept;
+    }
+}
+
+#endif
@@ -0,0 +1,81 @@
+#pragma once
+
+#if __cpp_exceptions
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "GpioLatency.hpp"
+#include "GpioMask.hpp"
+#include "GpioStats.hpp"
+
+namespace Components
+{
+    /**
+     * @brief Serializes the \c GpioStats counters into a compact binary blob for upload.
+     *
+     * Layout of format version 1, all integers except the first two bytes are unsigned LEB128 varints:
+     *  - version (one byte)
+     *  - flags (one byte): bit 0 set if the counters are deltas, bit 1 set if latency follows
+     *  - sequence number of the snapshot
+     *  - number of \c GPIOException errors
+     *  - number of pin records, then per pin: pin number (one byte), writes, toggles, interrupts
+     *  - if flagged: latency sample count, 50th, 90th and 99th percentile
+     *
+     * Delta snapshots contain the counter increments since the previous successfully encoded snapshot, whose
+     * sequence number is one less. Pins without any increments are left out, so an idle device produces a few
+     * bytes only. A receiver which missed a snapshot needs a full one, see \c encode().
+     *
+     * Everything is preallocated, encoding neither allocates nor throws.
+     */
+    class GpioTelemetry
+    {
+    public:
+        static constexpr uint8_t FORMAT_VERSION = 1;
+        static constexpr uint8_t FLAG_DELTA = 1u << 0;
+        static constexpr uint8_t FLAG_LATENCY = 1u << 1;
+
+        /**
+         * @param pins Pins to report.
+         */
+        explicit GpioTelemetry(const GpioMask &pins = GpioMask::valid()) noexcept;
+
+        /**
+         * @brief Also report the percentiles of \c histogram, e.g. filled by \c InterruptLatencyProbe::snapshot().
+         *
+         * The histogram has to outlive the exporter, nullptr stops reporting latency.
+         */
+        void setLatency(const LatencyHistogram *histogram) noexcept;
+
+        /**
+         * @brief Encode the next snapshot into \c buffer.
+         *
+         * @param delta Encode the increments since the last snapshot. The first snapshot is always a full one.
+         *
+         * @return the size of the snapshot, 0 if it didn't fit into \c buffer. In that case the baseline stays the
+         *         same, the next snapshot still contains all increments.
+         */
+        size_t encode(uint8_t *buffer, size_t size, bool delta = true) noexcept;
+
+        /**
+         * @brief Make the next snapshot a full one, e.g. after the receiver reported a missing sequence number.
+         */
+        void resetBaseline() noexcept;
+
+        /**
+         * @brief Upper bound of the size of a snapshot.
+         */
+        static constexpr size_t MAX_SIZE = 2 + 3 * 5 + GPIO_NUM_MAX * (1 + 3 * 5) + 4 * 5;
+
+    private:
+        GpioMask pins;
+        const LatencyHistogram *latency;
+        std::array<GpioPinCounters, GPIO_NUM_MAX> baseline;
+        uint32_t baseline_errors;
+        uint32_t sequence;
+        bool has_baseline;
+    };
+
+}
+
+#endif
@@ -0,0 +1,208 @@
+#pragma once
+
+#if __cpp_exceptions
+
+#include <cstddef>
+#include <cstdint>
+#include "Gpio.hpp"
+
+/**
+ * Recording of input reads and interrupts into a \c GpioTraceRecorder buffer. Define as 0 to remove the recording
+ * hooks from \c PinInput::getLevel() and the interrupt dispatch.
+ */
+#ifndef GPIO_TRACE_ENABLE
+#define GPIO_TRACE_ENABLE 1
+#endif
+
+namespace Components
+{
+    enum class GpioTraceEvent : uint8_t
+    {
+        READ,      ///< \c PinInput::getLevel() returned \c level
+        INTERRUPT, ///< the interrupt handler of the pin was called, \c level is the input level at ISR entry
+    };
+
+    /**
+     * @brief A decoded trace entry.
+     */
+    struct GpioTraceRecord
+    {
+        /**
+         * @brief Microseconds since the start of the recording.
+         */
+        uint64_t time_us;
+        uint8_t pin;
+        GpioTraceEvent event;
+        GPIOLevel level;
+    };
+
+    /**
+     * @brief Records all \c PinInput reads and interrupts with timestamps into a buffer provided by the user.
+     *
+     * Each event takes one 32 bit word: pin (6 bit), event (1 bit), level (1 bit) and the microseconds since the
+     * previous event (24 bit). Longer gaps add a time extension word with pin number 63 per 16.7 seconds. A
+     * megabyte holds roughly 260000 events.
+     *
+     * Recording stops when the buffer is full, further events are counted as dropped. Recording is done in a
+     * critical section, so reads on both cores and from ISRs end up in the order they happened.
+     * The recorder is process wide, hence all functions are static.
+     */
+    class GpioTraceRecorder
+    {
+    public:
+        static constexpr uint32_t TIME_BITS = 24;
+        static constexpr uint32_t MAX_DELTA_US = (1u << TIME_BITS) - 1;
+        static constexpr uint32_t TIME_EXTENSION_PIN = 63;
+
+        /**
+         * @brief Start recording into \c buffer of \c words words, which has to stay valid until \c stop().
+         */
+        static void start(uint32_t *buffer, size_t words) noexcept;
+
+        static void stop() noexcept;
+
+        /**
+         * @brief Number of words recorded.
+         */
+        static size_t size() noexcept;
+
+        /**
+         * @brief Number of events which didn't fit into the buffer.
+         */
+        static uint32_t dropped() noexcept;
+
+        static void recordRead(uint32_t pin, GPIOLevel level) noexcept;
+        static void recordInterrupt(uint32_t pin) noexcept;
+
+    private:
+        static void record(uint32_t pin, GpioTraceEvent event, GPIOLevel level) noexcept;
+    };
+
+    /**
+     * @brief Decodes a trace recorded by \c GpioTraceRecorder.
+     */
+    class GpioTraceReader
+    {
+    public:
+        GpioTraceReader(const uint32_t *words, size_t count) noexcept;
+
+        /**
+         * @brief Decode the next event.
+         *
+         * @return false at the end of the trace.
+         */
+        bool next(GpioTraceRecord &record) noexcept;
+
+        /**
+         * @brief Decode the next event without consuming it.
+         */
+        bool peek(GpioTraceRecord &record) const noexcept;
+
+        void rewind() noexcept;
+
+    private:
+        const uint32_t *words;
+        size_t count;
+        size_t position;
+        uint64_t time_us;
+    };
+
+#if CONFIG_IDF_TARGET_LINUX
+    /**
+     * @brief Feeds a recorded trace into the application code on the simulated register backend.
+     *
+     * Events are delivered as fast as possible, so hours of recording replay in seconds. In virtual time
+     * (\c GpioClock::setVirtual()), the clock is advanced to the recorded time of every event, so timestamps and
+     * timers seen by the application match the recording. Two ways of driving the replay can be combined:
+     *  - pull: while the replayer is attached, every \c PinInput::getLevel() returns the recorded level if the
+     *    next event is a read of the same pin. Otherwise the read counts as a mismatch and returns the simulated
+     *    input level. In virtual time, the clock skips to the recorded time of the read without firing timers,
+     *    like a delay. Interrupts and timers are never run from inside \c getLevel(), which is noexcept: call
+     *    \c deliverInterrupts() outside of the reading code, e.g. at the top of every main loop iteration. This
+     *    reproduces polling code exactly, as long as it reads the pins in the same order as on the device.
+     *  - push: \c step() and \c run() deliver events in order, applying the recorded levels to the simulated
+     *    inputs and calling the installed interrupt handlers. This drives interrupt based code.
+     *
+     * Reads done by interrupt handlers consume the reads recorded in those handlers. Only one replayer can be
+     * attached at a time.
+     */
+    class GpioTraceReplayer
+    {
+    public:
+        GpioTraceReplayer(const uint32_t *words, size_t count) noexcept;
+        ~GpioTraceReplayer();
+
+        GpioTraceReplayer(const GpioTraceReplayer &) = delete;
+        GpioTraceReplayer &operator=(const GpioTraceReplayer &) = delete;
+
+        /**
+         * @brief Serve \c PinInput::getLevel() from the trace.
+         */
+        void attach() noexcept;
+        void detach() noexcept;
+
+        /**
+         * @brief Deliver the next event.
+         *
+         * @return false at the end of the trace.
+         */
+        bool step();
+
+        /**
+         * @brief Deliver the interrupts recorded before the next read, firing the timers which become due.
+         *
+         * @return the number of interrupts delivered.
+         */
+        size_t deliverInterrupts();
+
+        /**
+         * @brief Deliver all remaining events.
+         *
+         * @return the number of events delivered.
+         */
+        size_t run();
+
+        /**
+         * @brief Deliver the events recorded up to \c time_us after the start of the recording.
+         *
+         * @return the number of events delivered.
+         */
+        size_t runUntil(uint64_t time_us);
+
+        /**
+         * @brief Recording time of the last delivered event.
+         */
+        uint64_t timeUs() const noexcept
+        {
+            return time_us;
+        }
+
+        /**
+         * @brief Reads which didn't match the next recorded read.
+         */
+        uint32_t mismatches() const noexcept
+        {
+            return mismatch_count;
+        }
+
+        bool finished() const noexcept;
+
+        /**
+         * @brief Called by \c PinInput::getLevel() on the Linux target, only consumes a read of \c pin.
+         *
+         * @return true if the attached replayer provided \c level.
+         */
+        static bool serveRead(uint32_t pin, GPIOLevel &level) noexcept;
+
+    private:
+        void deliver(const GpioTraceRecord &record);
+
+        GpioTraceReader reader;
+        uint64_t time_us;
+        uint32_t mismatch_count;
+    };
+#endif
+
+}
+
+#endif
@@ -0,0 +1,105 @@
+#pragma once
+
+#if __cpp_exceptions
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "Gpio.hpp"
+#include "GpioMask.hpp"
+
+struct gptimer_t;
+
+namespace Components
+{
+    /**
+     * @brief Toggles an output for an external watchdog from a hardware timer interrupt.
+     *
+     * The toggle does not depend on any task being scheduled. Instead, the application registers health checks,
+     * each of which has to be fed within its timeout. As soon as one check is overdue, the output stops toggling
+     * and the external watchdog resets the board, the same as if the whole system had hung.
+     *
+     * On the Linux target there is no hardware timer, a virtual timer of \c GpioClock ticks as virtual time advances.
+     * \c tick() can also be called directly.
+     */
+    class HeartbeatOutput
+    {
+    public:
+        static constexpr size_t MAX_CHECKS = 8;
+
+        /**
+         * @param pin Output connected to the watchdog input. It must outlive the heartbeat.
+         * @param half_period_us Time between two toggles.
+         *
+         * @throws GPIOException
+         *              - if the underlying driver function fails
+         */
+        HeartbeatOutput(PinOutput &pin, uint32_t half_period_us);
+        ~HeartbeatOutput();
+
+        HeartbeatOutput(const HeartbeatOutput &) = delete;
+        HeartbeatOutput &operator=(const HeartbeatOutput &) = delete;
+
+        /**
+         * @brief Register a health check which must be fed at least every \c timeout_us. It starts fed.
+         *
+         * @return the id to pass to \c feed().
+         *
+         * @throws GPIOException
+         *              - with ESP_ERR_NO_MEM if \c MAX_CHECKS checks exist already
+         */
+        size_t addCheck(uint32_t timeout_us);
+
+        /**
+         * @brief Report check \c check as healthy. Safe to call from ISR context.
+         */
+        void feed(size_t check) noexcept;
+
+        /**
+         * @brief True if no check is overdue.
+         */
+        bool isHealthy() const noexcept;
+
+        /**
+         * @brief Number of periods in which the output was not toggled because a check was overdue.
+         */
+        uint32_t getMissedToggles() const noexcept
+        {
+            return missed_toggles.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @throws GPIOException
+         *              - if the underlying driver function fails
+         */
+        void start();
+
+        /**
+         * @throws GPIOException
+         *              - if the underlying driver function fails
+         */
+        void stop();
+
+        /**
+         * @brief One heartbeat period: toggle the output if all checks are healthy. Called by the timer ISR.
+         */
+        void tick() noexcept;
+
+    private:
+        GpioMask pin_mask;
+        uint32_t half_period_us;
+        bool level;
+        size_t check_count;
+        std::array<uint32_t, MAX_CHECKS> timeouts_us;
+        std::array<std::atomic<int64_t>, MAX_CHECKS> deadlines_us;
+        std::atomic<uint32_t> missed_toggles;
+        gptimer_t *timer;
+#if CONFIG_IDF_TARGET_LINUX
+        int virtual_timer = -1;
+#endif
+    };
+
+}
+
+#endif
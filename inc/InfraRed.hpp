@@ -0,0 +1,201 @@
+#pragma once
+
+#if __cpp_exceptions
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "sdkconfig.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "soc/soc_caps.h"
+#endif
+#include "Gpio.hpp"
+#include "EdgeCapture.hpp"
+
+#if SOC_RMT_SUPPORTED && !CONFIG_IDF_TARGET_LINUX
+#define GPIO_IR_USE_RMT 1
+#else
+#define GPIO_IR_USE_RMT 0
+#endif
+
+struct rmt_channel_t;
+struct rmt_encoder_t;
+
+namespace Components
+{
+    /**
+     * @brief Infrared remote protocols known to the decoder and encoder.
+     */
+    enum class IRProtocol : uint8_t
+    {
+        NEC,
+        SONY,
+        RC5
+    };
+
+    /**
+     * @brief One mark (carrier on) followed by one space (carrier off), durations in microseconds.
+     *
+     * A space of 0 marks the end of a frame. This has the same shape as an RMT symbol.
+     */
+    struct IRSymbol
+    {
+        uint16_t mark_us;
+        uint16_t space_us;
+    };
+
+    /**
+     * @brief A decoded or to be sent remote control code.
+     *
+     * \c data holds the payload bits in transmission order starting at bit 0.
+     */
+    struct IRCode
+    {
+        IRProtocol protocol;
+        uint32_t data;
+        uint8_t bits;
+        bool repeat;
+
+        uint16_t getAddress() const noexcept;
+        uint16_t getCommand() const noexcept;
+    };
+
+    /**
+     * @brief A code already converted to its symbol sequence, so sending it needs no encoding work.
+     */
+    struct IRFrame
+    {
+        static constexpr size_t MAX_SYMBOLS = 40;
+
+        uint32_t carrier_hz;
+        size_t symbol_count;
+        std::array<IRSymbol, MAX_SYMBOLS> symbols;
+    };
+
+    /**
+     * @brief Table driven conversion between symbol sequences and codes.
+     */
+    namespace IRCodec
+    {
+        /**
+         * @brief Match \c symbols against all known protocols.
+         *
+         * @return
+         *      - ESP_OK if \c code was updated
+         *      - ESP_ERR_INVALID_RESPONSE if no protocol matched
+         */
+        esp_err_t decode(const IRSymbol *symbols, size_t count, IRCode &code) noexcept;
+
+        /**
+         * @brief Compute the symbol sequence and carrier for \c code.
+         *
+         * @return
+         *      - ESP_OK if \c frame was updated
+         *      - ESP_ERR_INVALID_SIZE if the bit count is not valid for the protocol
+         */
+        esp_err_t encode(const IRCode &code, IRFrame &frame) noexcept;
+    }
+
+    /**
+     * @brief Receives infrared remote codes from a demodulating receiver (e.g. TSOP38238, output active low).
+     *
+     * Symbols are captured by the RMT peripheral, so the CPU is only involved once per frame. On targets without
+     * RMT, edges are captured into an \c EdgeCapture ring instead.
+     */
+    class IRReceiver
+    {
+    public:
+        /**
+         * @throws GPIOException
+         *              - if the underlying driver function fails
+         */
+        explicit IRReceiver(GPIONum num);
+        ~IRReceiver();
+
+        IRReceiver(const IRReceiver &) = delete;
+        IRReceiver &operator=(const IRReceiver &) = delete;
+
+        /**
+         * @brief Decode the next complete frame, if any. Call this periodically from task context.
+         *
+         * @return
+         *      - ESP_OK if \c code was updated
+         *      - ESP_ERR_NOT_FOUND if no complete frame was received yet
+         *      - ESP_ERR_INVALID_RESPONSE if a frame was received but not recognized
+         *      - the error of the driver if reception couldn't be restarted after the last frame, it is retried
+         *        on every call
+         */
+        esp_err_t poll(IRCode &code) noexcept;
+
+    private:
+        static constexpr size_t MAX_SYMBOLS = 64;
+
+        std::array<IRSymbol, MAX_SYMBOLS> frame;
+        size_t frame_count;
+
+#if GPIO_IR_USE_RMT
+        esp_err_t restartReception() noexcept;
+
+        rmt_channel_t *channel;
+        std::array<uint32_t, MAX_SYMBOLS> raw;
+        std::atomic<size_t> received_count;
+        esp_err_t reception_error;
+#else
+        void collectEdges() noexcept;
+
+        PinInput pin;
+        EdgeCapture<256> capture;
+        // the last frame ended by the gap before the next one, kept until poll() decodes it
+        std::array<IRSymbol, MAX_SYMBOLS> completed;
+        size_t completed_count;
+        bool has_last_edge;
+        GPIOLevel last_level;
+        uint32_t last_time_us;
+#endif
+    };
+
+    /**
+     * @brief Sends infrared remote codes through the RMT peripheral with hardware carrier modulation.
+     */
+    class IRTransmitter
+    {
+    public:
+        /**
+         * @throws GPIOException
+         *              - if the underlying driver function fails
+         *              - with ESP_ERR_NOT_SUPPORTED on targets without RMT
+         */
+        explicit IRTransmitter(GPIONum num);
+        ~IRTransmitter();
+
+        IRTransmitter(const IRTransmitter &) = delete;
+        IRTransmitter &operator=(const IRTransmitter &) = delete;
+
+        /**
+         * @brief Send a prepared frame and wait until it is out.
+         *
+         * @throws GPIOException
+         *              - if the underlying driver function fails
+         */
+        void send(const IRFrame &frame);
+
+        /**
+         * @brief Encode and send \c code. Prefer preparing frames with \c IRCodec::encode() for repeated codes.
+         *
+         * @throws GPIOException
+         *              - if the underlying driver function fails or the code can't be encoded
+         */
+        void send(const IRCode &code);
+
+    private:
+#if GPIO_IR_USE_RMT
+        rmt_channel_t *channel;
+        rmt_encoder_t *encoder;
+        uint32_t carrier_hz;
+#endif
+    };
+
+}
+
+#endif
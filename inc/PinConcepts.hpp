@@ -0,0 +1,112 @@
+#pragma once
+
+#if __cpp_exceptions
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include "Gpio.hpp"
+#include "FastPin.hpp"
+#include "GpioPowerLock.hpp"
+#include "SyncOutputGroup.hpp"
+
+namespace Components
+{
+    /**
+     * @brief A pin whose level can be read, e.g. \c PinInput, \c PinOutputInput or \c FastPinInput.
+     */
+    template <typename T>
+    concept ReadablePin = requires(const T &pin) {
+        { pin.getLevel() } -> std::same_as<GPIOLevel>;
+    };
+
+    /**
+     * @brief A pin which can be driven high and low, e.g. \c PinOutput or \c FastPinOutput.
+     */
+    template <typename T>
+    concept WritablePin = requires(T &pin) {
+        pin.setHigh();
+        pin.setLow();
+    };
+
+    /**
+     * @brief An open drain pin which can be pulled low, released and read back, e.g. \c PinOutputInput or
+     * \c FastPinOutputInput.
+     */
+    template <typename T>
+    concept OpenDrainPin = ReadablePin<T> && requires(T &pin) {
+        pin.setFloating();
+        pin.setLow();
+    };
+
+    /**
+     * @brief Several outputs written at once, bit i of the levels is the level of pin i, e.g. \c SyncOutputGroup.
+     */
+    template <typename T>
+    concept GroupWritable = requires(T &group, uint32_t levels) {
+        group.write(levels);
+        group.setAllHigh();
+        group.setAllLow();
+    };
+
+    static_assert(ReadablePin<PinInput> && ReadablePin<PinOutputInput> && !ReadablePin<PinOutput>);
+    static_assert(WritablePin<PinOutput> && !WritablePin<PinInput> && !WritablePin<PinOutputInput>);
+    static_assert(OpenDrainPin<PinOutputInput> && !OpenDrainPin<PinInput> && !OpenDrainPin<PinOutput>);
+    static_assert(WritablePin<FastPinOutput<0>> && ReadablePin<FastPinInput<0>> && OpenDrainPin<FastPinOutputInput<0>>);
+    static_assert(GroupWritable<SyncOutputGroup>);
+
+    /**
+     * @brief Drive \c level on \c pin.
+     */
+    template <WritablePin Pin>
+    inline void writeLevel(Pin &pin, GPIOLevel level)
+    {
+        if (level == GPIOLevel::HIGH)
+        {
+            pin.setHigh();
+        }
+        else
+        {
+            pin.setLow();
+        }
+    }
+
+    /**
+     * @brief Drive \c level on an open drain \c pin, HIGH releases the pin.
+     */
+    template <OpenDrainPin Pin>
+    inline void writeLevel(Pin &pin, GPIOLevel level)
+    {
+        if (level == GPIOLevel::HIGH)
+        {
+            pin.setFloating();
+        }
+        else
+        {
+            pin.setLow();
+        }
+    }
+
+    /**
+     * @brief Bit-bang the lowest \c count bits of \c bits on \c data, clocked by a rising edge on \c clock.
+     *
+     * The clock has to be low before. Without any delay between the edges, the clock rate is limited by the pin
+     * backend: fast pins toggle in a few cycles, driver backed pins take much longer. The CPU is kept at its
+     * maximum frequency during the transfer.
+     */
+    template <WritablePin Data, WritablePin Clock>
+    inline void shiftOut(Data &data, Clock &clock, uint32_t bits, size_t count, bool msb_first = true)
+    {
+        GpioPowerGuard guard;
+        for (size_t i = 0; i < count; i++)
+        {
+            size_t bit = msb_first ? count - 1 - i : i;
+            writeLevel(data, (bits >> bit) & 1 ? GPIOLevel::HIGH : GPIOLevel::LOW);
+            clock.setHigh();
+            clock.setLow();
+        }
+    }
+
+}
+
+#endif
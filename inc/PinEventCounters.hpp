@@ -0,0 +1,115 @@
+#pragma once
+
+#if __cpp_exceptions
+
+#include <cstddef>
+#include <cstdint>
+#include "Gpio.hpp"
+#include "GpioMask.hpp"
+
+namespace Components
+{
+    /**
+     * @brief Event count and time of the last event of one pin, as kept by \c PinEventCounters.
+     */
+    struct PinEventRecord
+    {
+        uint32_t pin;
+
+        /**
+         * @brief Events since the counters were cleared.
+         */
+        uint32_t count;
+
+        /**
+         * @brief Events since the last \c PinEventCounters::markReported().
+         */
+        uint32_t unreported;
+
+        /**
+         * @brief Wall clock time of the last event in microseconds (gettimeofday(), kept by the RTC in deep sleep).
+         *
+         * Events counted by a ULP program are stamped with the time of the wakeup which merged them, their own
+         * time is not known.
+         */
+        int64_t last_event_us;
+    };
+
+    /**
+     * @brief Counts wakeup events of input pins in RTC memory, so the counts survive deep sleep.
+     *
+     * Typical use on a battery powered node: track the wakeup pins once, call \c recordWakeup() first thing after
+     * every wakeup and go back to sleep right away unless \c pendingEvents() reached the upload threshold. Then
+     * \c read() all records at once, upload them and \c markReported().
+     *
+     * Events can also be counted without waking the main CPU at all by a ULP program. Attach the ULP program's
+     * counter variable with \c attachUlpCounter(), its increments are merged into the record on every wakeup.
+     *
+     * The counters are process wide, hence all functions are static.
+     */
+    class PinEventCounters
+    {
+    public:
+        static constexpr size_t MAX_PINS = 8;
+
+        /**
+         * @brief Start counting events of \c num. Tracking an already tracked pin does nothing.
+         *
+         * @throws GPIOException
+         *              - with ESP_ERR_NO_MEM if \c MAX_PINS pins are tracked already
+         */
+        static void track(GPIONum num);
+
+        /**
+         * @brief Merge the increments of a counter maintained by a ULP program into the record of \c num.
+         *
+         * Meant to be called on every boot after \c track(). Attaching the counter which is attached already keeps
+         * its last merged value, so the increments made during deep sleep are merged by the next \c recordWakeup().
+         * A new counter or mask starts from the current value of the counter.
+         *
+         * @param counter Counter variable in RTC slow memory, e.g. \c &ulp_edge_count.
+         * @param mask Valid bits of the counter, ULP FSM programs only maintain the lower 16 bit.
+         *
+         * @throws GPIOException
+         *              - with ESP_ERR_NOT_FOUND if \c num is not tracked
+         */
+        static void attachUlpCounter(GPIONum num, const volatile uint32_t *counter, uint32_t mask = 0xffff);
+
+        /**
+         * @brief Count the pins which caused the current wakeup from deep sleep and merge ULP counters.
+         *
+         * Uses the EXT1 wakeup status or the GPIO wakeup status, whatever the chip supports.
+         */
+        static void recordWakeup() noexcept;
+
+        /**
+         * @brief Count one event for every tracked pin in \c pins at the current time.
+         */
+        static void recordEvents(const GpioMask &pins) noexcept;
+
+        /**
+         * @brief Copy the records of all tracked pins in one go.
+         *
+         * @return the number of records copied.
+         */
+        static size_t read(PinEventRecord *records, size_t max_records) noexcept;
+
+        /**
+         * @brief Sum of the unreported events of all pins.
+         */
+        static uint32_t pendingEvents() noexcept;
+
+        static void markReported() noexcept;
+
+        /**
+         * @brief Reset all counts, the pins stay tracked.
+         */
+        static void clear() noexcept;
+
+    private:
+        static void mergeUlpCounters(int64_t now_us) noexcept;
+    };
+
+}
+
+#endif
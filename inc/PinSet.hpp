@@ -0,0 +1,220 @@
+#pragma once
+
+#if __cpp_exceptions
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "Gpio.hpp"
+
+namespace Components
+{
+    /**
+     * @brief One byte reference to a pin, either a native GPIO or a pin of a user defined backend (e.g. an expander).
+     *
+     * The upper two bits hold the backend id, the lower six bits the pin index within that backend.
+     * Backend 0 is reserved for native GPIOs, its handles can only be created from a validated \c GPIONum.
+     */
+    class PinHandle
+    {
+    public:
+        static constexpr uint8_t NATIVE_BACKEND = 0;
+        static constexpr uint8_t MAX_BACKENDS = 4;
+        static constexpr uint8_t MAX_INDEX = 63;
+
+        constexpr PinHandle() noexcept : value(0) {}
+
+        explicit PinHandle(GPIONum num) noexcept : value(num.get_value<uint8_t>()) {}
+
+        /**
+         * @brief Create a handle for pin \c index of the non native backend \c backend.
+         *
+         * @throws GPIOException
+         *              - with ESP_ERR_INVALID_ARG if \c backend or \c index is out of range
+         */
+        static PinHandle fromBackend(uint8_t backend, uint8_t index)
+        {
+            if (backend == NATIVE_BACKEND || backend >= MAX_BACKENDS || index > MAX_INDEX)
+            {
+                throw GPIOException(ESP_ERR_INVALID_ARG);
+            }
+            return PinHandle(static_cast<uint8_t>((backend << INDEX_BITS) | index));
+        }
+
+        constexpr uint8_t getBackend() const noexcept
+        {
+            return value >> INDEX_BITS;
+        }
+
+        constexpr uint8_t getIndex() const noexcept
+        {
+            return value & MAX_INDEX;
+        }
+
+        constexpr bool isNative() const noexcept
+        {
+            return getBackend() == NATIVE_BACKEND;
+        }
+
+        constexpr bool operator==(const PinHandle &other) const noexcept
+        {
+            return value == other.value;
+        }
+
+        constexpr bool operator!=(const PinHandle &other) const noexcept
+        {
+            return value != other.value;
+        }
+
+    private:
+        static constexpr uint8_t INDEX_BITS = 6;
+
+        explicit constexpr PinHandle(uint8_t raw) noexcept : value(raw) {}
+
+        uint8_t value;
+    };
+
+    static_assert(sizeof(PinHandle) == 1, "PinHandle must stay one byte");
+
+    /**
+     * @brief Direction configuration of a pin in a \c PinSet.
+     */
+    enum class PinSetMode : uint8_t
+    {
+        DISABLED,
+        INPUT,
+        OUTPUT,
+        OUTPUT_INPUT_OD
+    };
+
+    /**
+     * @brief The complete configuration of a pin in a \c PinSet, packed into one byte.
+     */
+    struct PinSetConfig
+    {
+        uint8_t mode : 2;
+        uint8_t pull : 2;
+        uint8_t drive : 2;
+        uint8_t level : 1;
+        uint8_t reserved : 1;
+    };
+
+    static_assert(sizeof(PinSetConfig) == 1, "PinSetConfig must stay one byte");
+
+    /**
+     * @brief Storage of \c PinSet, a separate base so it is constructed before \c PinSetBase.
+     */
+    template <size_t CAPACITY>
+    struct PinSetStorage
+    {
+        std::array<PinHandle, CAPACITY> handle_storage;
+        std::array<PinSetConfig, CAPACITY> config_storage;
+    };
+
+    /**
+     * @brief Configuration table for many pins, stored as a structure of arrays.
+     *
+     * Handles and configurations are kept in two separate dense byte arrays, so a pin costs two bytes and walking
+     * over all configurations touches as few cache lines as possible. \c apply() configures all native pins sharing
+     * the same mode and pull configuration with a single driver call.
+     *
+     * This is the non-template base, use \c PinSet with a capacity to get the storage.
+     */
+    class PinSetBase
+    {
+    public:
+        PinSetBase(const PinSetBase &) = delete;
+        PinSetBase &operator=(const PinSetBase &) = delete;
+
+        /**
+         * @brief Add a pin to the set. The hardware is not touched until \c apply().
+         *
+         * @return the index of the pin in the set.
+         *
+         * @throws GPIOException
+         *              - with ESP_ERR_NO_MEM if the set is full
+         */
+        size_t add(PinHandle handle,
+                   PinSetMode mode,
+                   GPIOPullMode pull = GPIOPullMode::FLOATING(),
+                   GPIODriveStrength strength = GPIODriveStrength::DEFAULT());
+
+        /**
+         * @brief Write the configuration of all native pins to the hardware.
+         *
+         * Output levels are latched before any output is enabled.
+         *
+         * @throws GPIOException
+         *              - if the underlying driver function fails
+         */
+        void apply();
+
+        /**
+         * @brief Set the output level of the pin at \c index. Native pins are written immediately.
+         *
+         * @throws GPIOException
+         *              - if the underlying driver function fails
+         */
+        void setLevel(size_t index, GPIOLevel level);
+
+        /**
+         * @brief Read the level of the pin at \c index. For non native pins, the last set level is returned.
+         */
+        GPIOLevel getLevel(size_t index) const noexcept;
+
+        size_t size() const noexcept
+        {
+            return count;
+        }
+
+        size_t getCapacity() const noexcept
+        {
+            return capacity;
+        }
+
+        PinHandle getHandle(size_t index) const noexcept
+        {
+            return handles[index];
+        }
+
+        PinSetConfig getConfig(size_t index) const noexcept
+        {
+            return configs[index];
+        }
+
+        /**
+         * @brief Call \c fn(handle, config) for every pin in the set.
+         */
+        template <typename Fn>
+        void forEach(Fn &&fn) const
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                fn(handles[i], configs[i]);
+            }
+        }
+
+    protected:
+        PinSetBase(PinHandle *handles, PinSetConfig *configs, size_t capacity) noexcept;
+
+    private:
+        PinHandle *handles;
+        PinSetConfig *configs;
+        size_t capacity;
+        size_t count;
+    };
+
+    /**
+     * @brief Pin set with statically sized storage for \c CAPACITY pins.
+     */
+    template <size_t CAPACITY>
+    class PinSet : private PinSetStorage<CAPACITY>, public PinSetBase
+    {
+    public:
+        PinSet() noexcept
+            : PinSetStorage<CAPACITY>{}, PinSetBase(this->handle_storage.data(), this->config_storage.data(), CAPACITY) {}
+    };
+
+}
+
+#endif
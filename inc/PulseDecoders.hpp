@@ -0,0 +1,296 @@
+#pragma once
+
+#if __cpp_exceptions
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "Gpio.hpp"
+#include "EdgeCapture.hpp"
+
+namespace Components
+{
+    /**
+     * @brief What a decoder has to do after a pulse matched a rule.
+     */
+    enum class PulseAction : uint8_t
+    {
+        NONE,
+        BIT_0,
+        BIT_1,
+        VALUE,
+        SYNC
+    };
+
+    /**
+     * @brief One transition of a table driven pulse decoder.
+     *
+     * A pulse is a period in which the pin kept \c level (0 or 1, or \c ANY_LEVEL) for a duration within
+     * [min_us, max_us]. If it occurs in \c state, the decoder goes to \c next_state and performs \c action.
+     */
+    struct PulseRule
+    {
+        static constexpr uint8_t ANY_LEVEL = 2;
+
+        uint8_t state;
+        uint8_t level;
+        uint32_t min_us;
+        uint32_t max_us;
+        uint8_t next_state;
+        PulseAction action;
+    };
+
+    /**
+     * @brief Runs pulses through a table of \c PulseRule.
+     *
+     * Rules are checked in order, the first match wins. A pulse matching no rule resets the machine to state 0.
+     */
+    class PulseStateMachine
+    {
+    public:
+        PulseStateMachine(const PulseRule *rules, size_t rule_count) noexcept;
+
+        /**
+         * @return the matching rule or nullptr if the pulse did not match and the machine was reset.
+         */
+        const PulseRule *step(uint8_t level, uint32_t duration_us) noexcept;
+
+        void reset() noexcept;
+
+        uint8_t getState() const noexcept
+        {
+            return state;
+        }
+
+    private:
+        const PulseRule *rules;
+        size_t rule_count;
+        uint8_t state;
+    };
+
+    /**
+     * @brief Converts batches of captured edges into pulses (level and duration).
+     */
+    class PulseExtractor
+    {
+    public:
+        PulseExtractor() noexcept;
+
+        /**
+         * @brief Drain \c capture and call \c on_pulse(level, duration_us) for every completed pulse.
+         */
+        template <typename PulseFn>
+        void drain(EdgeCaptureBase &capture, PulseFn &&on_pulse)
+        {
+            std::array<GPIOEdge, BATCH_SIZE> batch;
+            size_t count;
+            while ((count = capture.read(batch.data(), batch.size())) > 0)
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    if (has_last_edge)
+                    {
+                        on_pulse(last_level, batch[i].time_us - last_time_us);
+                    }
+                    last_time_us = batch[i].time_us;
+                    last_level = batch[i].level == GPIOLevel::HIGH ? 1 : 0;
+                    has_last_edge = true;
+                }
+            }
+        }
+
+        void reset() noexcept;
+
+    private:
+        static constexpr size_t BATCH_SIZE = 16;
+
+        bool has_last_edge;
+        uint8_t last_level;
+        uint32_t last_time_us;
+    };
+
+    /**
+     * @brief A single reading of a DHT temperature and humidity sensor.
+     */
+    struct DHTReading
+    {
+        /**
+         * @brief Relative humidity in 0.1 %.
+         */
+        int16_t humidity;
+
+        /**
+         * @brief Temperature in 0.1 degree Celsius.
+         */
+        int16_t temperature;
+    };
+
+    /**
+     * @brief Reads DHT11 and DHT22 (AM2302) sensors on an open drain pin.
+     *
+     * The sensor response is captured by interrupt, \c read() decodes the captured edges in one batch.
+     */
+    class DHTSensor
+    {
+    public:
+        enum class Type
+        {
+            DHT11,
+            DHT22
+        };
+
+        /**
+         * @throws GPIOException
+         *              - if the underlying driver function fails
+         */
+        DHTSensor(PinOutputInput &pin, Type type);
+        ~DHTSensor();
+
+        /**
+         * @brief Send the start signal. The sensor answers within about 5ms, then call \c read().
+         *
+         * @throws GPIOException
+         *              - if the underlying driver function fails
+         */
+        void startReading();
+
+        /**
+         * @brief Decode the response to the last \c startReading().
+         *
+         * @return
+         *      - ESP_OK if \c reading was updated
+         *      - ESP_ERR_TIMEOUT if the response was incomplete
+         *      - ESP_ERR_INVALID_CRC if the checksum did not match
+         */
+        esp_err_t read(DHTReading &reading) noexcept;
+
+    private:
+        static constexpr size_t DATA_BITS = 40;
+
+        PinOutputInput &pin;
+        Type type;
+        EdgeCapture<128> capture;
+    };
+
+    /**
+     * @brief Distance measurement with HC-SR04 style ultrasonic sensors.
+     */
+    class UltrasonicSensor
+    {
+    public:
+        /**
+         * @throws GPIOException
+         *              - if the underlying driver function fails
+         */
+        UltrasonicSensor(PinOutput &trigger, PinInput &echo);
+        ~UltrasonicSensor();
+
+        /**
+         * @brief Send the trigger pulse. The echo is complete after at most 40ms.
+         *
+         * @throws GPIOException
+         *              - if the underlying driver function fails
+         */
+        void startMeasurement();
+
+        /**
+         * @brief Decode the echo of the last \c startMeasurement().
+         *
+         * @return
+         *      - ESP_OK if \c distance_mm was updated
+         *      - ESP_ERR_TIMEOUT if no valid echo pulse was captured (e.g. nothing in range)
+         */
+        esp_err_t readDistance(uint32_t &distance_mm) noexcept;
+
+    private:
+        PinOutput &trigger;
+        PinInput &echo;
+        EdgeCapture<8> capture;
+    };
+
+    /**
+     * @brief Decodes the pulse width of a single channel RC PWM signal (servo signal, 1000us to 2000us).
+     */
+    class RCPWMDecoder
+    {
+    public:
+        /**
+         * @throws GPIOException
+         *              - if the underlying driver function fails
+         */
+        explicit RCPWMDecoder(PinInput &pin);
+        ~RCPWMDecoder();
+
+        /**
+         * @brief Decode all captured edges.
+         *
+         * @return the number of valid pulses decoded.
+         */
+        size_t process() noexcept;
+
+        /**
+         * @brief The last valid pulse width in microseconds, 0 if none was seen yet.
+         */
+        uint32_t getPulseWidth() const noexcept
+        {
+            return pulse_width_us;
+        }
+
+    private:
+        EdgeCapture<16> capture;
+        PulseExtractor extractor;
+        PulseStateMachine machine;
+        uint32_t pulse_width_us;
+    };
+
+    /**
+     * @brief Decodes a multi channel RC PPM sum signal.
+     *
+     * Channel values are measured between rising edges, a gap longer than the sync threshold starts a new frame.
+     */
+    class RCPPMDecoder
+    {
+    public:
+        static constexpr size_t MAX_CHANNELS = 16;
+
+        /**
+         * @throws GPIOException
+         *              - if the underlying driver function fails
+         */
+        explicit RCPPMDecoder(PinInput &pin);
+        ~RCPPMDecoder();
+
+        /**
+         * @brief Decode all captured edges.
+         *
+         * @return the number of complete frames decoded.
+         */
+        size_t process() noexcept;
+
+        /**
+         * @brief Number of channels in the last complete frame.
+         */
+        size_t getChannelCount() const noexcept
+        {
+            return channel_count;
+        }
+
+        /**
+         * @brief Value of \c channel in microseconds from the last complete frame, 0 if unknown.
+         */
+        uint32_t getChannel(size_t channel) const noexcept;
+
+    private:
+        EdgeCapture<64> capture;
+        PulseStateMachine machine;
+        bool has_rising_edge;
+        uint32_t last_rising_us;
+        size_t channel_index;
+        size_t channel_count;
+        std::array<uint16_t, MAX_CHANNELS> pending;
+        std::array<uint16_t, MAX_CHANNELS> channels;
+    };
+
+}
+
+#endif
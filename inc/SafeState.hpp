@@ -0,0 +1,63 @@
+#pragma once
+
+#if __cpp_exceptions
+
+#include <cstdint>
+#include "Gpio.hpp"
+#include "GpioMask.hpp"
+
+namespace Components
+{
+    /**
+     * @brief Registry of the safe levels of all outputs, to be applied at once in an emergency.
+     *
+     * The safe levels are kept as precomputed set and clear masks in internal RAM. \c apply() only stores these
+     * masks to the output registers, one or two stores per bank, so it is safe to call from any context: ISRs,
+     * fault handlers, a wrapped panic handler or with the flash cache disabled.
+     *
+     * Outputs should be registered during initialization. Registering while \c apply() may run concurrently can
+     * apply a partially updated mask.
+     */
+    class SafeState
+    {
+    public:
+        /**
+         * @brief Drive \c pin to \c safe_level on \c apply().
+         */
+        static void registerOutput(const PinOutput &pin, GPIOLevel safe_level) noexcept;
+
+        /**
+         * @brief Release \c pin (open drain high) on \c apply().
+         */
+        static void registerOutput(const PinOutputInput &pin) noexcept;
+
+        static void unregisterOutput(const GPIO &pin) noexcept;
+
+        /**
+         * @brief Drive all registered outputs to their safe levels. IRAM resident, never throws.
+         */
+        static void apply() noexcept;
+
+        /**
+         * @brief Also apply the safe state on every esp_restart().
+         *
+         * Shutdown handlers don't run on panics, watchdog or brownout resets. To cover panics, call \c apply() from
+         * a panic handler wrapper (linker option \c -Wl,--wrap=esp_panic_handler).
+         *
+         * @throws GPIOException
+         *              - if the underlying driver function fails
+         */
+        static void installShutdownHandler();
+
+        /**
+         * @brief Run \c apply() once and return how long it took in CPU cycles (nanoseconds on Linux).
+         */
+        static uint32_t measureApply() noexcept;
+
+        static GpioMask getSafeHigh() noexcept;
+        static GpioMask getSafeLow() noexcept;
+    };
+
+}
+
+#endif
@@ -0,0 +1,279 @@
+#pragma once
+
+#if __cpp_exceptions
+
+#include <cstddef>
+#include <cstdint>
+#include "SimulatedNets.hpp"
+
+namespace Components
+{
+    /**
+     * @brief 74HC595 style shift register on \c SimulatedNets.
+     *
+     * Shifts the data line in on rising clock edges, MSB first, and copies the shift stage to the outputs on
+     * rising latch edges. Cascaded chips are modeled as one register of up to 32 bits.
+     *
+     * Like all simulated devices, it has to be destroyed before the nets it is connected to.
+     */
+    class SimulatedShiftRegister
+    {
+    public:
+        /**
+         * @throws GPIOException with ESP_ERR_INVALID_ARG if \c bits is 0 or above 32, see also
+         *         \c SimulatedNets::addListener().
+         */
+        SimulatedShiftRegister(SimulatedNets &nets, size_t data, size_t clock, size_t latch, uint32_t bits = 8);
+        ~SimulatedShiftRegister();
+
+        SimulatedShiftRegister(const SimulatedShiftRegister &) = delete;
+        SimulatedShiftRegister &operator=(const SimulatedShiftRegister &) = delete;
+
+        /**
+         * @brief The latched outputs, the last bit shifted in is bit 0.
+         */
+        uint32_t getOutputs() const noexcept
+        {
+            return outputs;
+        }
+
+        /**
+         * @brief Number of rising clock edges seen.
+         */
+        uint32_t getClockCount() const noexcept
+        {
+            return clock_count;
+        }
+
+    private:
+        static void onEdge(void *arg, size_t net, bool level, uint64_t time_ns) noexcept;
+
+        SimulatedNets &nets;
+        size_t data;
+        size_t clock;
+        size_t latch;
+        uint32_t mask;
+        uint32_t shift;
+        uint32_t outputs;
+        uint32_t clock_count;
+    };
+
+    /**
+     * @brief 24Cxx style I2C EEPROM on \c SimulatedNets.
+     *
+     * Supports byte and page writes with the page pointer wrapping inside the page, random, current address and
+     * sequential reads. Memories above 256 bytes use two address bytes. After a write, the device doesn't
+     * acknowledge its address for \c write_time_us, so acknowledge polling can be tested.
+     *
+     * SDA needs a pull-up, the device only pulls it low.
+     */
+    class SimulatedI2cEeprom
+    {
+    public:
+        /**
+         * @param memory Contents of the EEPROM, \c size bytes, owned by the caller.
+         * @param page_size Power of two.
+         *
+         * @throws GPIOException with ESP_ERR_INVALID_ARG if \c size is 0 or \c page_size isn't a power of two,
+         *         see also \c SimulatedNets::addPort().
+         */
+        SimulatedI2cEeprom(SimulatedNets &nets, size_t sda, size_t scl, uint8_t *memory, size_t size,
+                           uint8_t address = 0x50, size_t page_size = 16, uint32_t write_time_us = 5000);
+        ~SimulatedI2cEeprom();
+
+        SimulatedI2cEeprom(const SimulatedI2cEeprom &) = delete;
+        SimulatedI2cEeprom &operator=(const SimulatedI2cEeprom &) = delete;
+
+        /**
+         * @brief Number of write cycles started by a STOP condition.
+         */
+        uint32_t getWriteCount() const noexcept
+        {
+            return write_count;
+        }
+
+    private:
+        enum class Phase : uint8_t
+        {
+            IDLE,       ///< waiting for a START condition
+            RECEIVE,    ///< clocking in a byte from the master
+            ACK,        ///< acknowledging the received byte
+            SEND,       ///< clocking out a byte
+            MASTER_ACK, ///< waiting for the acknowledge of the master
+        };
+
+        static void onEdge(void *arg, size_t net, bool level, uint64_t time_ns) noexcept;
+        void onClock(bool level, uint64_t time_ns) noexcept;
+        bool receiveByte(uint8_t byte, uint64_t time_ns) noexcept;
+        void sendBit(uint64_t time_ns) noexcept;
+
+        SimulatedNets &nets;
+        size_t sda;
+        size_t scl;
+        size_t port;
+        uint8_t *memory;
+        size_t size;
+        size_t page_size;
+        uint64_t write_time_ns;
+        uint64_t busy_until_ns;
+        size_t pointer;
+        uint32_t write_count;
+        uint8_t address;
+        uint8_t address_bytes;
+        uint8_t byte_index;
+        uint8_t bits;
+        uint8_t shift;
+        Phase phase;
+        bool reading;
+        bool written;
+        bool master_nack;
+    };
+
+    /**
+     * @brief 25-series SPI NOR flash on \c SimulatedNets, SPI mode 0.
+     *
+     * Supports READ (0x03), PAGE PROGRAM (0x02), SECTOR ERASE (0x20, 4 KiB), CHIP ERASE (0xC7), WRITE ENABLE
+     * (0x06), WRITE DISABLE (0x04), READ STATUS (0x05) and JEDEC ID (0x9F). Programming only clears bits and
+     * wraps inside the 256 byte page. Program and erase start when CS goes high, need the write enable latch and
+     * set the busy bit of the status register for their typical duration, other commands are ignored meanwhile.
+     */
+    class SimulatedSpiFlash
+    {
+    public:
+        static constexpr uint32_t PAGE_PROGRAM_US = 700;
+        static constexpr uint32_t SECTOR_ERASE_US = 45000;
+        static constexpr uint32_t CHIP_ERASE_US = 10000000;
+
+        /**
+         * @param memory Contents of the flash, \c size bytes, owned by the caller. Erased flash reads 0xFF.
+         *
+         * @throws GPIOException with ESP_ERR_INVALID_ARG if \c size is 0, see also \c SimulatedNets::addPort().
+         */
+        SimulatedSpiFlash(SimulatedNets &nets, size_t cs, size_t sck, size_t mosi, size_t miso,
+                          uint8_t *memory, size_t size, uint32_t jedec_id = 0xEF4016);
+        ~SimulatedSpiFlash();
+
+        SimulatedSpiFlash(const SimulatedSpiFlash &) = delete;
+        SimulatedSpiFlash &operator=(const SimulatedSpiFlash &) = delete;
+
+        /**
+         * @brief Number of commands received, i.e. CS low periods with at least one byte.
+         */
+        uint32_t getCommandCount() const noexcept
+        {
+            return command_count;
+        }
+
+    private:
+        static void onEdge(void *arg, size_t net, bool level, uint64_t time_ns) noexcept;
+        void select(uint64_t time_ns) noexcept;
+        void deselect(uint64_t time_ns) noexcept;
+        void receiveByte(uint8_t byte, uint64_t time_ns) noexcept;
+        uint8_t status(uint64_t time_ns) const noexcept;
+
+        SimulatedNets &nets;
+        size_t cs;
+        size_t sck;
+        size_t mosi;
+        size_t port;
+        uint8_t *memory;
+        size_t size;
+        uint32_t jedec_id;
+        uint64_t busy_until_ns;
+        size_t address;
+        uint32_t command_count;
+        uint32_t byte_index;
+        uint8_t command;
+        uint8_t bits;
+        uint8_t rx;
+        uint8_t tx;
+        bool selected;
+        bool output;
+        bool write_enable;
+        bool writable;
+    };
+
+    /**
+     * @brief DS18B20 style 1-Wire temperature sensor on \c SimulatedNets.
+     *
+     * Decodes reset, write and read slots from the low times of the bus, answers resets with a presence pulse and
+     * supports READ ROM, SKIP ROM, MATCH ROM and SEARCH ROM, so several sensors can share a bus, as well as CONVERT
+     * T, READ SCRATCHPAD and WRITE SCRATCHPAD. The conversion takes the time given by the configured resolution,
+     * read slots return 0 until it is done. The bus needs a pull-up.
+     */
+    class SimulatedOneWireSensor
+    {
+    public:
+        static constexpr uint8_t FAMILY_CODE = 0x28;
+
+        /**
+         * @param serial The 48 bit serial number of the ROM code.
+         *
+         * @throws GPIOException, see \c SimulatedNets::addPort().
+         */
+        SimulatedOneWireSensor(SimulatedNets &nets, size_t dq, uint64_t serial);
+        ~SimulatedOneWireSensor();
+
+        SimulatedOneWireSensor(const SimulatedOneWireSensor &) = delete;
+        SimulatedOneWireSensor &operator=(const SimulatedOneWireSensor &) = delete;
+
+        /**
+         * @brief Temperature measured by the next conversion.
+         */
+        void setTemperature(float celsius) noexcept;
+
+        /**
+         * @brief The 64 bit ROM code, family code in the lowest byte, CRC in the highest.
+         */
+        uint64_t getRom() const noexcept;
+
+        /**
+         * @brief Dallas/Maxim CRC-8 as used by ROM codes and the scratchpad.
+         */
+        static uint8_t crc8(const uint8_t *data, size_t size) noexcept;
+
+    private:
+        enum class Stage : uint8_t
+        {
+            IDLE,
+            PRESENCE,
+            ROM_COMMAND,
+            READ_ROM,
+            MATCH_ROM,
+            SEARCH_ROM,
+            FUNCTION_COMMAND,
+            CONVERTING,
+            READ_SCRATCHPAD,
+            WRITE_SCRATCHPAD,
+        };
+
+        static void onEdge(void *arg, size_t net, bool level, uint64_t time_ns) noexcept;
+        bool transmitBit(bool &bit, uint64_t time_ns) const noexcept;
+        void endTransmitSlot() noexcept;
+        void receiveBit(bool bit, uint64_t time_ns) noexcept;
+        void receiveByte(uint8_t byte, uint64_t time_ns) noexcept;
+        void startTransmit(const uint8_t *data, size_t size, Stage transmit, Stage next) noexcept;
+
+        SimulatedNets &nets;
+        size_t dq;
+        size_t port;
+        uint8_t rom[8];
+        uint8_t scratchpad[9];
+        uint8_t tx[9];
+        int16_t temperature;
+        uint64_t fall_ns;
+        uint64_t busy_until_ns;
+        uint32_t tx_size;
+        uint32_t tx_bit;
+        uint32_t search_bit;
+        uint8_t search_step;
+        uint8_t rx;
+        uint8_t rx_bits;
+        uint8_t rx_count;
+        Stage stage;
+        Stage after_transmit;
+    };
+
+}
+
+#endif
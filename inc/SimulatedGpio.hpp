@@ -0,0 +1,153 @@
+#pragma once
+
+#if __cpp_exceptions
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "GpioMask.hpp"
+
+namespace Components
+{
+    class SimulatedNets;
+
+    /**
+     * @brief Host side model of the GPIO output, output enable and input registers.
+     *
+     * On CONFIG_IDF_TARGET_LINUX, the bank register layer (\c GpioBanks) reads and writes this model instead of
+     * hardware registers, so grouped pin operations can be verified on the host. The input of a pin reflects its
+     * output latch if the output is enabled, otherwise the level applied from outside with \c setExternal().
+     * Pins connected to a net of an attached \c SimulatedNets read the level of their net instead.
+     *
+     * The registers are lock free atomics with the semantics of the hardware: stores to the set and clear
+     * registers are atomic read-modify-writes, so host threads can drive different pins of the same bank like the
+     * two cores do. Whole register stores (\c writeOutput(), \c setOutputEnable()) replace the bank. The trace
+     * is safe to fill from several threads, but should be read once they are done. \c SimulatedNets, the
+     * virtual \c GpioClock and \c reset() are single threaded.
+     */
+    class SimulatedGpioRegisters
+    {
+    public:
+        static constexpr size_t BANK_COUNT = GpioMask::BANK_COUNT;
+
+        /**
+         * @brief A traced store: the time and the output bits it changed.
+         */
+        struct StoreRecord
+        {
+            uint32_t time;
+            uint32_t bank;
+            uint32_t changed;
+        };
+
+        static constexpr size_t TRACE_SIZE = 64;
+
+        SimulatedGpioRegisters() noexcept;
+
+        /**
+         * @brief The register file used by the Linux target.
+         */
+        static SimulatedGpioRegisters &instance() noexcept;
+
+        /**
+         * @brief Model a store to the W1TS and W1TC output registers of \c bank. Zero masks are no stores.
+         */
+        void write(size_t bank, uint32_t set, uint32_t clear) noexcept;
+
+        /**
+         * @brief Model a store to the output register of \c bank.
+         */
+        void writeOutput(size_t bank, uint32_t value) noexcept;
+
+        uint32_t readOutput(size_t bank) const noexcept;
+        uint32_t readInput(size_t bank) const noexcept;
+
+        void setOutputEnable(size_t bank, uint32_t mask) noexcept;
+
+        /**
+         * @brief Model stores to the W1TS and W1TC output enable registers of \c bank.
+         */
+        void writeOutputEnable(size_t bank, uint32_t set, uint32_t clear) noexcept;
+
+        uint32_t getOutputEnable(size_t bank) const noexcept;
+
+        /**
+         * @brief Open drain outputs only pull low, a high output latch releases the pin.
+         */
+        void setOpenDrain(uint32_t pin, bool enable) noexcept;
+        uint32_t getOpenDrain(size_t bank) const noexcept;
+
+        /**
+         * @brief Model the internal pull resistors of \c pin.
+         */
+        void setPull(uint32_t pin, bool up, bool down) noexcept;
+        uint32_t getPullUp(size_t bank) const noexcept;
+        uint32_t getPullDown(size_t bank) const noexcept;
+
+        /**
+         * @brief Apply \c level from outside to \c pin, visible on the input while the output is disabled.
+         */
+        void setExternal(uint32_t pin, bool level) noexcept;
+
+        /**
+         * @brief Resolve the connected pins through \c nets, nullptr goes back to ideal levels.
+         *
+         * Called by \c SimulatedNets itself.
+         */
+        void attachNets(SimulatedNets *nets) noexcept;
+
+        SimulatedNets *getNets() const noexcept
+        {
+            return nets;
+        }
+
+        /**
+         * @brief Number of modeled register stores since the last \c reset().
+         */
+        uint32_t getStoreCount() const noexcept
+        {
+            return store_count.load(std::memory_order_relaxed);
+        }
+
+        void reset() noexcept;
+
+        /**
+         * @brief Record every store with a \c GpioClock::cycles() timestamp, up to \c TRACE_SIZE stores.
+         */
+        void setTracing(bool enable) noexcept;
+
+        /**
+         * @brief Copy the traced stores in order, then clear the trace.
+         *
+         * @return the number of records copied.
+         */
+        size_t readTrace(StoreRecord *records, size_t max_records) noexcept;
+
+    private:
+        void trace(size_t bank, uint32_t before, uint32_t after) noexcept;
+        void notify(size_t bank, uint32_t changed) noexcept;
+
+        std::array<std::atomic<uint32_t>, BANK_COUNT> output;
+        std::array<std::atomic<uint32_t>, BANK_COUNT> output_enable;
+        std::array<std::atomic<uint32_t>, BANK_COUNT> open_drain;
+        std::array<std::atomic<uint32_t>, BANK_COUNT> pull_up;
+        std::array<std::atomic<uint32_t>, BANK_COUNT> pull_down;
+        std::array<std::atomic<uint32_t>, BANK_COUNT> external;
+        SimulatedNets *nets;
+        std::atomic<uint32_t> store_count;
+        std::atomic<bool> tracing;
+        std::atomic<size_t> trace_count;
+        std::array<StoreRecord, TRACE_SIZE> trace_records;
+    };
+
+    /**
+     * @brief Call the handler installed with \c PinInput::interruptEnable() for \c pin, as its ISR would.
+     *
+     * Does nothing if the interrupt of \c pin is not enabled. Implemented by the GPIO classes on the Linux target.
+     */
+    void simulateInterrupt(uint32_t pin);
+
+}
+
+#endif
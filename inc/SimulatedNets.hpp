@@ -0,0 +1,244 @@
+#pragma once
+
+#if __cpp_exceptions
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "SimulatedGpio.hpp"
+
+namespace Components
+{
+    /**
+     * @brief What a driver does to its net.
+     */
+    enum class NetDrive : uint8_t
+    {
+        RELEASED, ///< high impedance, e.g. an input or an open drain output at high level
+        LOW,
+        HIGH,
+    };
+
+    /**
+     * @brief Electrical model of the wires between the simulated GPIO pins and simulated devices.
+     *
+     * A net connects any number of chip pins and device ports, may have external pull resistors and has a
+     * capacitance. The level of a net is resolved like on a real board:
+     *  - strong drivers (push-pull outputs, open drain outputs pulling low, device ports) win over pulls. If
+     *    drivers disagree, the net is contended, the contention is counted and the level stays where it was,
+     *  - without strong drivers, the resistor divider of all pulls decides, a pull-up and an equally strong
+     *    pull-down keep the previous level,
+     *  - without drivers or pulls, the net is floating and keeps its charge.
+     *
+     * Edges caused by pulls take the RC time until the 50 % threshold, 0.69 * R * C, with the resistance R of the
+     * pulls and the net capacitance C, measured on the \c GpioClock. So an open drain line released with the
+     * internal pull-up of the chip (\c INTERNAL_PULL_OHMS) and 100 pF rises after about 3 us. Driven edges take
+     * a few nanoseconds on a real board and are visible immediately. Use virtual time (\c GpioClock::setVirtual())
+     * for reproducible edges.
+     *
+     * The pins take part with their output latch, output enable, open drain and pull settings of the attached
+     * \c SimulatedGpioRegisters. Every change of a pin or port only updates the sums of its own net, so setting
+     * a pin costs the same no matter how many nets and devices exist. Interrupts are not raised by net changes,
+     * use \c simulateInterrupt() where needed.
+     *
+     * Simulated devices attach to nets with ports and listeners. Level changes and scheduled port drives are
+     * processed in time order whenever the nets are accessed: on every register access of a connected pin, on
+     * \c getLevel() and on \c poll(). Listeners get the time of the change, so devices measure pulse lengths
+     * and answer at the right time even though they run later than the change. Nothing happens while the
+     * application only waits, call \c poll() after advancing the clock without touching a pin.
+     *
+     * Pins not connected to a net keep the ideal behavior of \c SimulatedGpioRegisters.
+     */
+    class SimulatedNets
+    {
+    public:
+        static constexpr size_t MAX_NETS = 32;
+        static constexpr size_t MAX_PORTS = 64;
+        static constexpr size_t MAX_LISTENERS = 32;
+
+        /**
+         * @brief Called with the new \c level of \c net and the time of the change on the \c GpioClock.
+         */
+        using Listener = void (*)(void *arg, size_t net, bool level, uint64_t time_ns) noexcept;
+
+        /**
+         * @brief Typical resistance of the internal pull-up and pull-down of the ESP32 pads.
+         */
+        static constexpr uint32_t INTERNAL_PULL_OHMS = 45000;
+
+        /**
+         * @brief Attach to \c registers, which then read the levels of connected pins from the nets.
+         */
+        explicit SimulatedNets(SimulatedGpioRegisters &registers = SimulatedGpioRegisters::instance()) noexcept;
+        ~SimulatedNets();
+
+        SimulatedNets(const SimulatedNets &) = delete;
+        SimulatedNets &operator=(const SimulatedNets &) = delete;
+
+        /**
+         * @brief Add a net with the capacitance of wire, pads and device inputs.
+         *
+         * @return the net index.
+         * @throws GPIOException with ESP_ERR_NO_MEM if \c MAX_NETS are in use.
+         */
+        size_t addNet(uint32_t capacitance_pf = 10);
+
+        /**
+         * @brief Connect chip pin \c pin to \c net.
+         *
+         * @throws GPIOException with ESP_ERR_INVALID_ARG if the net or pin doesn't exist or the pin is connected
+         *         already.
+         */
+        void connectPin(size_t net, uint32_t pin);
+
+        /**
+         * @brief Add an external pull resistor of \c ohms to \c net.
+         *
+         * @throws GPIOException with ESP_ERR_INVALID_ARG if the net doesn't exist or \c ohms is 0.
+         */
+        void addPull(size_t net, uint32_t ohms, bool up);
+
+        /**
+         * @brief Add a device port on \c net, released initially.
+         *
+         * @return the port index for \c drive().
+         * @throws GPIOException with ESP_ERR_NO_MEM if \c MAX_PORTS are in use, ESP_ERR_INVALID_ARG if the net
+         *         doesn't exist.
+         */
+        size_t addPort(size_t net);
+
+        /**
+         * @brief Call \c listener on every level change of \c net.
+         *
+         * @throws GPIOException with ESP_ERR_NO_MEM if \c MAX_LISTENERS are in use, ESP_ERR_INVALID_ARG if the net
+         *         doesn't exist.
+         */
+        void addListener(size_t net, Listener listener, void *arg);
+
+        /**
+         * @brief Remove all listeners registered with \c arg, e.g. when a device is destroyed.
+         */
+        void removeListeners(void *arg) noexcept;
+
+        /**
+         * @brief Change the drive of \c port now.
+         */
+        void drive(size_t port, NetDrive drive) noexcept;
+
+        /**
+         * @brief Change the drive of \c port at \c time_ns, replacing a change scheduled before.
+         *
+         * Meant for listeners, which pass the time of the edge they react to plus their response time.
+         *
+         * @param release_ns If not 0, release the port again at this time, to drive a pulse.
+         */
+        void scheduleDrive(size_t port, NetDrive drive, uint64_t time_ns, uint64_t release_ns = 0) noexcept;
+
+        /**
+         * @brief Process the level changes and scheduled drives due by now.
+         */
+        void poll() noexcept;
+
+        /**
+         * @brief The level seen by inputs on \c net now.
+         */
+        bool getLevel(size_t net) noexcept;
+
+        /**
+         * @brief The level seen on the net \c port is connected to.
+         */
+        bool getPortLevel(size_t port) noexcept;
+
+        /**
+         * @brief Time until the last change of \c net is visible, 0 if the net has settled.
+         */
+        uint64_t settlingNs(size_t net) noexcept;
+
+        bool isContended(size_t net) const noexcept;
+        bool isFloating(size_t net) const noexcept;
+
+        /**
+         * @brief Number of times \c net went into contention.
+         */
+        uint32_t getContentions(size_t net) const noexcept;
+
+        /**
+         * @brief Sum of \c getContentions() of all nets.
+         */
+        uint32_t getTotalContentions() const noexcept;
+
+        /**
+         * @brief Called by the registers after the settings of \c pins in \c bank changed.
+         */
+        void updatePins(size_t bank, uint32_t pins) noexcept;
+
+        /**
+         * @brief Levels of the pins in \c bank, valid for the bits set in \c connected.
+         */
+        uint32_t readBank(size_t bank, uint32_t &connected) noexcept;
+
+    private:
+        /*
+         * What a pin, port or resistor adds to its net. Conductances are in nanosiemens, so they add up exactly.
+         */
+        struct Contribution
+        {
+            NetDrive drive;
+            uint32_t pull_up;
+            uint32_t pull_down;
+        };
+
+        struct Net
+        {
+            uint32_t capacitance_pf;
+            uint16_t drive_high;
+            uint16_t drive_low;
+            uint32_t pull_up;
+            uint32_t pull_down;
+            uint64_t settle_ns;
+            uint32_t contentions;
+            bool level;
+            bool target;
+            bool contended;
+        };
+
+        struct Port
+        {
+            uint8_t net;
+            NetDrive drive;
+            NetDrive scheduled_drive;
+            uint64_t scheduled_ns;
+            uint64_t release_ns;
+        };
+
+        struct ListenerSlot
+        {
+            size_t net;
+            Listener listener;
+            void *arg;
+        };
+
+        Contribution pinContribution(uint32_t pin) const noexcept;
+        void apply(size_t net, const Contribution &before, const Contribution &after, uint64_t now) noexcept;
+        void resolve(size_t net, uint64_t now) noexcept;
+        void setLevel(size_t net, bool level, uint64_t now) noexcept;
+        void driveAt(size_t port, NetDrive drive, uint64_t now) noexcept;
+
+        SimulatedGpioRegisters &registers;
+        std::array<Net, MAX_NETS> nets;
+        size_t net_count;
+        std::array<Port, MAX_PORTS> ports;
+        size_t port_count;
+        std::array<int8_t, GPIO_NUM_MAX> pin_nets;
+        std::array<Contribution, GPIO_NUM_MAX> pin_contributions;
+        std::array<uint32_t, SimulatedGpioRegisters::BANK_COUNT> connected_pins;
+        std::array<ListenerSlot, MAX_LISTENERS> listeners;
+        size_t listener_count;
+        uint32_t pending_nets;
+        uint64_t scheduled_ports;
+        bool polling;
+    };
+
+}
+
+#endif
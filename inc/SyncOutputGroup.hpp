@@ -0,0 +1,119 @@
+#pragma once
+
+#if __cpp_exceptions
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include "Gpio.hpp"
+#include "GpioMask.hpp"
+
+namespace Components
+{
+    /**
+     * @brief How the outputs of a \c SyncOutputGroup are written.
+     */
+    enum class SyncWriteMode : uint8_t
+    {
+        INDIVIDUAL,  ///< one \c PinOutput call per pin
+        GROUPED,     ///< set and clear stores per bank (\c SyncOutputGroup::write())
+        SYNCHRONOUS, ///< one output register store per bank (\c SyncOutputGroup::writeSynchronous())
+    };
+
+    /**
+     * @brief Inter-pin skew of one group write.
+     */
+    struct OutputSkew
+    {
+        /**
+         * @brief Time between the first and the last store changing a pin of the group, in CPU cycles
+         * (nanoseconds on Linux).
+         */
+        uint32_t max_skew;
+
+        /**
+         * @brief Number of stores which changed a pin of the group.
+         */
+        uint32_t stores;
+    };
+
+    /**
+     * @brief A group of up to 32 outputs which are updated together.
+     *
+     * Writing pins one by one via \c PinOutput goes through the driver for every pin and spreads the edges over
+     * microseconds. The group writes the output registers directly instead:
+     *  - \c write() stores the rising pins of a bank with one store and the falling pins with a second one, so
+     *    pins changing in the same direction within a bank change in the same cycle.
+     *  - \c writeSynchronous() stores the new levels of a bank with one store to its output register, so all pins
+     *    of a bank change in the same cycle regardless of their direction.
+     *
+     * Pins in different banks (GPIO32 and higher on ESP32 and ESP32-S3) can't be changed with the same store.
+     * The skew between the banks is bounded by one register store, a few APB cycles, plus the time of the second
+     * store of bank 0 for \c write(). Keep pins that have to switch together in one bank.
+     *
+     * Bit i of the level arguments is the level of pin i, in the order the pins were given to the constructor.
+     * The \c PinOutput objects have to outlive the group.
+     */
+    class SyncOutputGroup
+    {
+    public:
+        static constexpr size_t MAX_PINS = 32;
+
+        /**
+         * @throws GPIOException
+         *              - with ESP_ERR_INVALID_ARG if there are no or more than \c MAX_PINS pins
+         */
+        SyncOutputGroup(std::initializer_list<std::reference_wrapper<PinOutput>> pins);
+
+        /**
+         * @brief Drive the pins to \c levels with at most two stores per bank.
+         */
+        void write(uint32_t levels) noexcept;
+
+        /**
+         * @brief Drive the pins to \c levels with one store to the output register per bank.
+         *
+         * The output register is read, modified and written back inside a critical section. Outputs of the same
+         * bank which are not in the group must not be changed from another core or an interrupt which can't be
+         * masked at the same time, the change could be lost.
+         */
+        void writeSynchronous(uint32_t levels) noexcept;
+
+        void setAllHigh() noexcept;
+        void setAllLow() noexcept;
+
+        /**
+         * @brief Write \c levels in \c mode and measure the skew between the pins.
+         *
+         * On target, a cycle counter timestamp is taken after each store. On Linux, the skew is computed from the
+         * store trace of \c SimulatedGpioRegisters, only stores which changed a pin of the group are counted there.
+         *
+         * @throws GPIOException
+         *              - if the underlying driver function fails in INDIVIDUAL mode
+         */
+        OutputSkew measureSkew(uint32_t levels, SyncWriteMode mode);
+
+        const GpioMask &getMask() const noexcept
+        {
+            return mask;
+        }
+
+        size_t size() const noexcept
+        {
+            return count;
+        }
+
+    private:
+        GpioMask levelMask(uint32_t levels) const noexcept;
+
+        std::array<PinOutput *, MAX_PINS> pins;
+        std::array<uint8_t, MAX_PINS> nums;
+        size_t count;
+        GpioMask mask;
+    };
+
+}
+
+#endif
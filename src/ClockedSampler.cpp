@@ -0,0 +1,220 @@
+#if __cpp_exceptions
+
+#include "esp_attr.h"
+#include "ClockedSampler.hpp"
+#include "GpioBanks.hpp"
+#include "GpioClock.hpp"
+
+namespace Components
+{
+
+    namespace
+    {
+        inline void writeBit(uint8_t *buffer, size_t position, bool value) noexcept
+        {
+            uint8_t mask = static_cast<uint8_t>(1u << (position & 7));
+            if (value)
+            {
+                buffer[position >> 3] |= mask;
+            }
+            else
+            {
+                buffer[position >> 3] &= static_cast<uint8_t>(~mask);
+            }
+        }
+
+        inline bool readBit(const uint8_t *buffer, size_t position) noexcept
+        {
+            return (buffer[position >> 3] >> (position & 7)) & 1;
+        }
+    }
+
+    ClockedSampler::ClockedSampler(PinInput &clock,
+                                   std::initializer_list<std::reference_wrapper<const PinInput>> data,
+                                   uint8_t *buffer,
+                                   size_t buffer_size,
+                                   GPIOIntrType edge)
+        : clock(clock),
+          edge(edge),
+          data_pins{},
+          data_count(data.size()),
+          input_mask(),
+          buffer(buffer),
+          capacity(0),
+          head(0),
+          tail(0),
+          overflow_count(0),
+          power_lock(GpioPowerLock::timing()),
+          running(false)
+    {
+        if (data_count == 0 || data_count > MAX_DATA_PINS)
+        {
+            throw GPIOException(ESP_ERR_INVALID_ARG);
+        }
+
+        size_t i = 0;
+        for (const PinInput &pin : data)
+        {
+            data_pins[i] = pin.getNum().get_value<uint8_t>();
+            input_mask.set(data_pins[i]);
+            i++;
+        }
+        input_mask.set(clock.getNum().get_value<uint32_t>());
+
+        size_t max_samples = buffer_size * 8 / data_count;
+        if (max_samples < 2)
+        {
+            throw GPIOException(ESP_ERR_INVALID_ARG);
+        }
+        capacity = 1;
+        while (capacity * 2 <= max_samples)
+        {
+            capacity *= 2;
+        }
+    }
+
+    ClockedSampler::~ClockedSampler()
+    {
+        if (running)
+        {
+            try
+            {
+                stop();
+            }
+            catch (const GPIOException &)
+            {
+            }
+        }
+    }
+
+    void ClockedSampler::start()
+    {
+        if (running)
+        {
+            return;
+        }
+
+        power_lock.acquire();
+        try
+        {
+            clock.interruptEnable(edge, isrHandler, this);
+        }
+        catch (const GPIOException &)
+        {
+            power_lock.release();
+            throw;
+        }
+        running = true;
+    }
+
+    void ClockedSampler::stop()
+    {
+        clock.interruptDisable();
+        if (running)
+        {
+            power_lock.release();
+        }
+        running = false;
+    }
+
+    GpioMask IRAM_ATTR ClockedSampler::readInputs() const noexcept
+    {
+        return GpioBanks::read(input_mask);
+    }
+
+    void IRAM_ATTR ClockedSampler::store(const GpioMask &inputs) noexcept
+    {
+        size_t current_head = head.load(std::memory_order_relaxed);
+        if (current_head - tail.load(std::memory_order_acquire) >= capacity)
+        {
+            overflow_count.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        size_t position = (current_head & (capacity - 1)) * data_count;
+        for (size_t i = 0; i < data_count; i++)
+        {
+            writeBit(buffer, position + i, inputs.contains(data_pins[i]));
+        }
+        head.store(current_head + 1, std::memory_order_release);
+    }
+
+    size_t IRAM_ATTR ClockedSampler::captureBlocking(size_t samples, uint32_t timeout_us) noexcept
+    {
+        const uint32_t clock_pin = clock.getNum().get_value<uint32_t>();
+        const bool on_rising = edge != GPIOIntrType::NEGEDGE();
+        const bool on_falling = edge != GPIOIntrType::POSEDGE();
+        GpioPowerGuard guard(power_lock);
+        const int64_t deadline = GpioClock::nowUs() + timeout_us;
+
+        GpioMask inputs = readInputs();
+        bool last_clock = inputs.contains(clock_pin);
+        size_t taken = 0;
+        uint32_t polls = 0;
+
+        while (taken < samples)
+        {
+            inputs = readInputs();
+            bool current_clock = inputs.contains(clock_pin);
+            if (current_clock != last_clock)
+            {
+                last_clock = current_clock;
+                if (current_clock ? on_rising : on_falling)
+                {
+                    store(inputs);
+                    taken++;
+                }
+            }
+
+            // reading the timer is much slower than a register poll, so only check the timeout now and then
+            if ((++polls & 0xff) == 0 && GpioClock::nowUs() >= deadline)
+            {
+                break;
+            }
+        }
+
+        return taken;
+    }
+
+    size_t ClockedSampler::read(uint8_t *out, size_t max_samples) noexcept
+    {
+        size_t current_tail = tail.load(std::memory_order_relaxed);
+        size_t count = head.load(std::memory_order_acquire) - current_tail;
+        if (count > max_samples)
+        {
+            count = max_samples;
+        }
+
+        for (size_t sample = 0; sample < count; sample++)
+        {
+            size_t source = ((current_tail + sample) & (capacity - 1)) * data_count;
+            size_t destination = sample * data_count;
+            for (size_t i = 0; i < data_count; i++)
+            {
+                writeBit(out, destination + i, readBit(buffer, source + i));
+            }
+        }
+
+        tail.store(current_tail + count, std::memory_order_release);
+        return count;
+    }
+
+    size_t ClockedSampler::available() const noexcept
+    {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_relaxed);
+    }
+
+    uint32_t ClockedSampler::overflows() const noexcept
+    {
+        return overflow_count.load(std::memory_order_relaxed);
+    }
+
+    void IRAM_ATTR ClockedSampler::isrHandler(void *arg)
+    {
+        auto *sampler = static_cast<ClockedSampler *>(arg);
+        sampler->store(sampler->readInputs());
+    }
+
+}
+
+#endif
@@ -0,0 +1,91 @@
+#if __cpp_exceptions
+
+#include "esp_attr.h"
+#include "EdgeCapture.hpp"
+#include "GpioBanks.hpp"
+#include "GpioClock.hpp"
+
+namespace Components
+{
+
+    EdgeCaptureBase::EdgeCaptureBase(GPIOEdge *storage, size_t capacity) noexcept
+        : storage(storage), mask(capacity - 1), head(0), tail(0), overflow_count(0), pin(nullptr),
+          pin_bank(0), pin_bit(0) {}
+
+    void EdgeCaptureBase::start(PinInput &input, GPIOIntrType type)
+    {
+        uint32_t num = input.getNum().get_value<uint32_t>();
+        pin = &input;
+        pin_bank = num / GpioMask::BANK_BITS;
+        pin_bit = 1u << (num % GpioMask::BANK_BITS);
+        pin->interruptEnable(type, isrHandler, this);
+    }
+
+    void EdgeCaptureBase::stop()
+    {
+        if (pin)
+        {
+            pin->interruptDisable();
+            pin = nullptr;
+        }
+    }
+
+    void IRAM_ATTR EdgeCaptureBase::push(uint32_t time_us, GPIOLevel level) noexcept
+    {
+        size_t current_head = head.load(std::memory_order_relaxed);
+        if (current_head - tail.load(std::memory_order_acquire) > mask)
+        {
+            overflow_count.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        storage[current_head & mask] = GPIOEdge{time_us, level};
+        head.store(current_head + 1, std::memory_order_release);
+    }
+
+    size_t EdgeCaptureBase::read(GPIOEdge *edges, size_t max_count) noexcept
+    {
+        size_t current_tail = tail.load(std::memory_order_relaxed);
+        size_t count = head.load(std::memory_order_acquire) - current_tail;
+        if (count > max_count)
+        {
+            count = max_count;
+        }
+
+        for (size_t i = 0; i < count; i++)
+        {
+            edges[i] = storage[(current_tail + i) & mask];
+        }
+
+        tail.store(current_tail + count, std::memory_order_release);
+        return count;
+    }
+
+    size_t EdgeCaptureBase::available() const noexcept
+    {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_relaxed);
+    }
+
+    void EdgeCaptureBase::clear() noexcept
+    {
+        tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+        overflow_count.store(0, std::memory_order_relaxed);
+    }
+
+    uint32_t EdgeCaptureBase::overflows() const noexcept
+    {
+        return overflow_count.load(std::memory_order_relaxed);
+    }
+
+    void IRAM_ATTR EdgeCaptureBase::isrHandler(void *arg)
+    {
+        auto *capture = static_cast<EdgeCaptureBase *>(arg);
+        uint32_t now = static_cast<uint32_t>(GpioClock::nowUs());
+        // PinInput::getLevel() isn't IRAM resident, read the input register directly
+        bool high = GpioBanks::readBank(capture->pin_bank) & capture->pin_bit;
+        capture->push(now, high ? GPIOLevel::HIGH : GPIOLevel::LOW);
+    }
+
+}
+
+#endif
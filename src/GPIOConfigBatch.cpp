@@ -0,0 +1,116 @@
+#if __cpp_exceptions
+
+#include "driver/gpio.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "soc/gpio_periph.h"
+#include "soc/io_mux_reg.h"
+#include "soc/soc.h"
+#endif
+#include "GPIOConfigBatch.hpp"
+#if CONFIG_IDF_TARGET_LINUX
+#include "SimulatedGpio.hpp"
+#endif
+
+namespace Components
+{
+
+#define GPIO_CHECK_THROW(err) CHECK_THROW_SPECIFIC((err), GPIOException)
+
+    GPIOConfigBatch::GPIOConfigBatch() noexcept
+    {
+        clear();
+    }
+
+    void GPIOConfigBatch::setPullMode(const PinInput &pin, GPIOPullMode mode) noexcept
+    {
+        uint32_t num = pin.getNum().get_value<uint32_t>();
+        settings[num].pull = mode.get_value<uint8_t>();
+        settings[num].pull_set = 1;
+        pending.set(num);
+    }
+
+    void GPIOConfigBatch::setDriveStrength(const PinOutput &pin, GPIODriveStrength strength) noexcept
+    {
+        recordDriveStrength(pin.getNum().get_value<uint32_t>(), strength);
+    }
+
+    void GPIOConfigBatch::setDriveStrength(const PinOutputInput &pin, GPIODriveStrength strength) noexcept
+    {
+        recordDriveStrength(pin.getNum().get_value<uint32_t>(), strength);
+    }
+
+    void GPIOConfigBatch::recordDriveStrength(uint32_t pin, GPIODriveStrength strength) noexcept
+    {
+        settings[pin].drive = strength.get_value<uint8_t>();
+        settings[pin].drive_set = 1;
+        pending.set(pin);
+    }
+
+    void GPIOConfigBatch::commit()
+    {
+        for (uint32_t pin : pending)
+        {
+            const PinSettings &pin_settings = settings[pin];
+            gpio_num_t num = static_cast<gpio_num_t>(pin);
+
+            if (!isPlainIoMuxPad(pin))
+            {
+                if (pin_settings.pull_set)
+                {
+#if CONFIG_IDF_TARGET_LINUX
+                    gpio_pull_mode_t pull = static_cast<gpio_pull_mode_t>(pin_settings.pull);
+                    SimulatedGpioRegisters::instance().setPull(pin,
+                                                               pull == GPIO_PULLUP_ONLY || pull == GPIO_PULLUP_PULLDOWN,
+                                                               pull == GPIO_PULLDOWN_ONLY || pull == GPIO_PULLUP_PULLDOWN);
+#else
+                    GPIO_CHECK_THROW(gpio_set_pull_mode(num, static_cast<gpio_pull_mode_t>(pin_settings.pull)));
+#endif
+                }
+                if (pin_settings.drive_set)
+                {
+                    GPIO_CHECK_THROW(gpio_set_drive_capability(num, static_cast<gpio_drive_cap_t>(pin_settings.drive)));
+                }
+                continue;
+            }
+
+#if !CONFIG_IDF_TARGET_LINUX
+            if (!GPIO_PIN_MUX_REG[pin])
+            {
+                throw GPIOException(ESP_ERR_INVALID_ARG);
+            }
+
+            uint32_t value = REG_READ(GPIO_PIN_MUX_REG[pin]);
+            if (pin_settings.pull_set)
+            {
+                gpio_pull_mode_t pull = static_cast<gpio_pull_mode_t>(pin_settings.pull);
+                value &= ~(FUN_PU | FUN_PD);
+                if (pull == GPIO_PULLUP_ONLY || pull == GPIO_PULLUP_PULLDOWN)
+                {
+                    value |= FUN_PU;
+                }
+                if (pull == GPIO_PULLDOWN_ONLY || pull == GPIO_PULLUP_PULLDOWN)
+                {
+                    value |= FUN_PD;
+                }
+            }
+            if (pin_settings.drive_set)
+            {
+                value &= ~(FUN_DRV_V << FUN_DRV_S);
+                value |= (static_cast<uint32_t>(pin_settings.drive) & FUN_DRV_V) << FUN_DRV_S;
+            }
+            REG_WRITE(GPIO_PIN_MUX_REG[pin], value);
+#endif
+        }
+
+        clear();
+    }
+
+    void GPIOConfigBatch::clear() noexcept
+    {
+        pending = GpioMask();
+        settings.fill(PinSettings{});
+    }
+
+}
+
+#endif
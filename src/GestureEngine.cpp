@@ -0,0 +1,224 @@
+#if __cpp_exceptions
+
+#include <utility>
+#include "esp_timer.h"
+#include "GestureEngine.hpp"
+#include "GpioBanks.hpp"
+#include "GpioClock.hpp"
+
+namespace Components
+{
+
+#define GPIO_CHECK_THROW(err) CHECK_THROW_SPECIFIC((err), GPIOException)
+
+    namespace
+    {
+        void timerCallback(void *arg)
+        {
+            static_cast<GestureEngine *>(arg)->tick();
+        }
+    }
+
+    GestureEngine::GestureEngine(const GestureTiming &timing) noexcept
+        : timing(timing),
+          debounce_mask(0),
+          pins(),
+          button_count(0),
+          buttons{},
+          queue{},
+          head(0),
+          tail(0),
+          dropped_events(0),
+          timer(nullptr)
+    {
+        uint8_t samples = timing.debounce_samples;
+        if (samples < 1)
+        {
+            samples = 1;
+        }
+        else if (samples > 8)
+        {
+            samples = 8;
+        }
+        debounce_mask = static_cast<uint8_t>((1u << samples) - 1);
+    }
+
+    GestureEngine::~GestureEngine()
+    {
+#if CONFIG_IDF_TARGET_LINUX
+        GpioClock::stopTimer(virtual_timer);
+#endif
+        if (timer)
+        {
+            esp_timer_stop(timer);
+            esp_timer_delete(timer);
+        }
+    }
+
+    size_t GestureEngine::addButton(const PinInput &pin, bool active_low)
+    {
+        if (button_count == MAX_BUTTONS)
+        {
+            throw GPIOException(ESP_ERR_NO_MEM);
+        }
+
+        Button button = {};
+        button.pin = pin.getNum().get_value<uint8_t>();
+        button.active_low = active_low;
+        button.state = IDLE;
+        buttons[button_count] = button;
+        pins.set(button.pin);
+        return button_count++;
+    }
+
+    void GestureEngine::start(uint32_t period_us)
+    {
+#if CONFIG_IDF_TARGET_LINUX
+        // the id is cleared first so a throwing startTimer() doesn't leave a stale one behind
+        GpioClock::stopTimer(std::exchange(virtual_timer, -1));
+        virtual_timer = GpioClock::startTimer(timerCallback, this, period_us);
+#else
+        if (!timer)
+        {
+            esp_timer_create_args_t args = {};
+            args.callback = timerCallback;
+            args.arg = this;
+            args.dispatch_method = ESP_TIMER_TASK;
+            args.name = "gestures";
+            args.skip_unhandled_events = true;
+            GPIO_CHECK_THROW(esp_timer_create(&args, &timer));
+        }
+        GPIO_CHECK_THROW(esp_timer_start_periodic(timer, period_us));
+#endif
+    }
+
+    void GestureEngine::stop()
+    {
+#if CONFIG_IDF_TARGET_LINUX
+        GpioClock::stopTimer(std::exchange(virtual_timer, -1));
+#endif
+        if (timer)
+        {
+            GPIO_CHECK_THROW(esp_timer_stop(timer));
+        }
+    }
+
+    void GestureEngine::tick() noexcept
+    {
+        GpioMask levels = GpioBanks::read(pins);
+
+        for (size_t i = 0; i < button_count; i++)
+        {
+            Button &button = buttons[i];
+            bool active = levels.contains(button.pin) != static_cast<bool>(button.active_low);
+            button.history = static_cast<uint8_t>((button.history << 1) | active);
+
+            uint8_t recent = button.history & debounce_mask;
+            if (recent == debounce_mask)
+            {
+                button.pressed = 1;
+            }
+            else if (recent == 0)
+            {
+                button.pressed = 0;
+            }
+
+            advance(static_cast<uint8_t>(i), button, button.pressed);
+        }
+    }
+
+    void GestureEngine::advance(uint8_t index, Button &button, bool pressed) noexcept
+    {
+        if (button.ticks < UINT16_MAX)
+        {
+            button.ticks++;
+        }
+
+        switch (button.state)
+        {
+        case IDLE:
+            if (pressed)
+            {
+                button.state = PRESSED;
+                button.ticks = 0;
+            }
+            break;
+
+        case PRESSED:
+            if (!pressed)
+            {
+                if (button.clicks < 15)
+                {
+                    button.clicks++;
+                }
+                button.state = WAIT_NEXT;
+                button.ticks = 0;
+            }
+            else if (button.ticks >= timing.long_press_ticks)
+            {
+                emit(index, GestureType::LONG_PRESS);
+                button.clicks = 0;
+                button.state = HOLDING;
+                button.ticks = 0;
+            }
+            break;
+
+        case HOLDING:
+            if (!pressed)
+            {
+                emit(index, GestureType::LONG_RELEASE);
+                button.state = IDLE;
+                button.ticks = 0;
+            }
+            else if (button.ticks >= timing.repeat_ticks)
+            {
+                emit(index, GestureType::HOLD_REPEAT);
+                button.ticks = 0;
+            }
+            break;
+
+        case WAIT_NEXT:
+            if (pressed)
+            {
+                button.state = PRESSED;
+                button.ticks = 0;
+            }
+            else if (button.ticks >= timing.double_click_gap_ticks)
+            {
+                emit(index, button.clicks >= 2 ? GestureType::DOUBLE_CLICK : GestureType::CLICK);
+                button.clicks = 0;
+                button.state = IDLE;
+            }
+            break;
+        }
+    }
+
+    void GestureEngine::emit(uint8_t button, GestureType type) noexcept
+    {
+        size_t current_head = head.load(std::memory_order_relaxed);
+        if (current_head - tail.load(std::memory_order_acquire) >= QUEUE_SIZE)
+        {
+            dropped_events.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        queue[current_head % QUEUE_SIZE] = GestureEvent{button, type};
+        head.store(current_head + 1, std::memory_order_release);
+    }
+
+    bool GestureEngine::poll(GestureEvent &event) noexcept
+    {
+        size_t current_tail = tail.load(std::memory_order_relaxed);
+        if (current_tail == head.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        event = queue[current_tail % QUEUE_SIZE];
+        tail.store(current_tail + 1, std::memory_order_release);
+        return true;
+    }
+
+}
+
+#endif
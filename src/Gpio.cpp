@@ -1,49 +1,244 @@
 #if __cpp_exceptions
 
 #include <array>
+#include <cstdint>
 #include "driver/gpio.h"
+#include "esp_attr.h"
 #include "Gpio.hpp"
+#include "GpioMask.hpp"
+#include "GpioDiagnostics.hpp"
+#include "GpioStats.hpp"
+#include "GpioTrace.hpp"
+#if CONFIG_IDF_TARGET_LINUX
+#include "SimulatedGpio.hpp"
+#else
+#include "soc/soc_caps.h"
+#if SOC_RTCIO_INPUT_OUTPUT_SUPPORTED
+#include "driver/rtc_io.h"
+#endif
+#endif
 using namespace System;
 namespace Components
 {
 
 #define GPIO_CHECK_THROW(err) CHECK_THROW_SPECIFIC((err), GPIOException)
 
+    GPIOException::GPIOException(esp_err_t error) : ESPException(error)
+    {
+#if GPIO_STATS_ENABLE
+        GpioStats::countError();
+#endif
+    }
+
     namespace
     {
-#if CONFIG_IDF_TARGET_LINUX
-        constexpr std::array<uint32_t, 1> INVALID_GPIOS = {24};
-#elif CONFIG_IDF_TARGET_ESP32
-        constexpr std::array<uint32_t, 1> INVALID_GPIOS = {24};
-#elif CONFIG_IDF_TARGET_ESP32S2
-        constexpr std::array<uint32_t, 4> INVALID_GPIOS = {22, 23, 24, 25};
+        static_assert(GPIO_NUM_MAX <= 64, "pin masks are 64 bit");
+
+        constexpr uint64_t VALID_PINS = GpioMask::valid().toBits();
+
+        // D- and D+ of the internal USB PHY used by the USB Serial/JTAG peripheral
+#if CONFIG_IDF_TARGET_ESP32C3
+        constexpr uint64_t USB_PHY_PINS = (1ULL << 18) | (1ULL << 19);
 #elif CONFIG_IDF_TARGET_ESP32S3
-        constexpr std::array<uint32_t, 4> INVALID_GPIOS = {22, 23, 24, 25};
-#elif CONFIG_IDF_TARGET_ESP32C3
-        constexpr std::array<uint32_t, 0> INVALID_GPIOS = {};
-#elif CONFIG_IDF_TARGET_ESP32C2
-        constexpr std::array<uint32_t, 0> INVALID_GPIOS = {};
+        constexpr uint64_t USB_PHY_PINS = (1ULL << 19) | (1ULL << 20);
+#else
+        constexpr uint64_t USB_PHY_PINS = 0;
+#endif
+
+        /*
+         * Every driver call of the GPIO classes goes through these, so the Linux target can run them against the
+         * simulated register file instead of the driver stubs.
+         */
+#if CONFIG_IDF_TARGET_LINUX
+        esp_err_t setPinLevel(gpio_num_t num, uint32_t level) noexcept
+        {
+            uint32_t bit = 1u << (num % GpioMask::BANK_BITS);
+            SimulatedGpioRegisters::instance().write(num / GpioMask::BANK_BITS, level ? bit : 0, level ? 0 : bit);
+#if GPIO_STATS_ENABLE
+            GpioStats::countWrite(num, level != 0);
+#endif
+            return ESP_OK;
+        }
+
+        int getPinLevel(gpio_num_t num) noexcept
+        {
+            uint32_t bank = SimulatedGpioRegisters::instance().readInput(num / GpioMask::BANK_BITS);
+            return (bank >> (num % GpioMask::BANK_BITS)) & 1;
+        }
+
+        esp_err_t setPinDirection(gpio_num_t num, gpio_mode_t mode) noexcept
+        {
+            SimulatedGpioRegisters &registers = SimulatedGpioRegisters::instance();
+            size_t bank = num / GpioMask::BANK_BITS;
+            uint32_t bit = 1u << (num % GpioMask::BANK_BITS);
+            bool output = mode == GPIO_MODE_OUTPUT || mode == GPIO_MODE_INPUT_OUTPUT_OD;
+            registers.setOpenDrain(num, mode == GPIO_MODE_INPUT_OUTPUT_OD);
+            registers.writeOutputEnable(bank, output ? bit : 0, output ? 0 : bit);
+            return ESP_OK;
+        }
+
+        esp_err_t setPinPull(gpio_num_t num, gpio_pull_mode_t mode) noexcept
+        {
+            SimulatedGpioRegisters::instance().setPull(num,
+                                                       mode == GPIO_PULLUP_ONLY || mode == GPIO_PULLUP_PULLDOWN,
+                                                       mode == GPIO_PULLDOWN_ONLY || mode == GPIO_PULLUP_PULLDOWN);
+            return ESP_OK;
+        }
+
+        // the register file has no pad settings, the drive strength is only kept to be read back
+        std::array<gpio_drive_cap_t, GPIO_NUM_MAX> drive_strengths;
+
+        esp_err_t resetPin(gpio_num_t num) noexcept
+        {
+            // like gpio_reset_pin(): output disabled, pull-up enabled, default drive strength
+            setPinDirection(num, GPIO_MODE_INPUT);
+            SimulatedGpioRegisters::instance().setPull(num, true, false);
+            drive_strengths[num] = GPIO_DRIVE_CAP_2;
+            return ESP_OK;
+        }
+
+        esp_err_t setPinHold(gpio_num_t num, bool enable) noexcept
+        {
+            (void)num;
+            (void)enable;
+            return ESP_OK;
+        }
+
+        esp_err_t setPinDriveStrength(gpio_num_t num, gpio_drive_cap_t strength) noexcept
+        {
+            drive_strengths[num] = strength;
+            return ESP_OK;
+        }
+
+        esp_err_t getPinDriveStrength(gpio_num_t num, gpio_drive_cap_t *strength) noexcept
+        {
+            *strength = drive_strengths[num];
+            return ESP_OK;
+        }
+
+        esp_err_t setPinWakeup(gpio_num_t num, gpio_int_type_t type, bool enable) noexcept
+        {
+            (void)num;
+            (void)type;
+            (void)enable;
+            return ESP_OK;
+        }
 #else
-#error "No GPIOs defined for the current target"
+        inline esp_err_t setPinLevel(gpio_num_t num, uint32_t level) noexcept
+        {
+            esp_err_t result = gpio_set_level(num, level);
+#if GPIO_STATS_ENABLE
+            if (result == ESP_OK)
+            {
+                GpioStats::countWrite(num, level != 0);
+            }
 #endif
+            return result;
+        }
+
+        inline int getPinLevel(gpio_num_t num) noexcept
+        {
+            return gpio_get_level(num);
+        }
+
+        inline esp_err_t setPinDirection(gpio_num_t num, gpio_mode_t mode) noexcept
+        {
+            return gpio_set_direction(num, mode);
+        }
+
+        inline esp_err_t setPinPull(gpio_num_t num, gpio_pull_mode_t mode) noexcept
+        {
+            return gpio_set_pull_mode(num, mode);
+        }
+
+        inline esp_err_t resetPin(gpio_num_t num) noexcept
+        {
+            return gpio_reset_pin(num);
+        }
+
+        inline esp_err_t setPinHold(gpio_num_t num, bool enable) noexcept
+        {
+            return enable ? gpio_hold_en(num) : gpio_hold_dis(num);
+        }
 
+        inline esp_err_t setPinDriveStrength(gpio_num_t num, gpio_drive_cap_t strength) noexcept
+        {
+            return gpio_set_drive_capability(num, strength);
+        }
+
+        inline esp_err_t getPinDriveStrength(gpio_num_t num, gpio_drive_cap_t *strength) noexcept
+        {
+            return gpio_get_drive_capability(num, strength);
+        }
+
+        inline esp_err_t setPinWakeup(gpio_num_t num, gpio_int_type_t type, bool enable) noexcept
+        {
+            return enable ? gpio_wakeup_enable(num, type) : gpio_wakeup_disable(num);
+        }
+#endif
+
+#define GPIO_ISR_DISPATCH (GPIO_STATS_ENABLE || GPIO_TRACE_ENABLE || CONFIG_IDF_TARGET_LINUX)
+
+#if GPIO_ISR_DISPATCH
+        /*
+         * Interrupt handlers are installed through dispatchIsr(), which counts and records the interrupt and calls
+         * the handler of the pin passed as its argument. On Linux, it is also the entry for simulated interrupts.
+         */
+        struct IsrSlot
+        {
+            GPIOISRHandler handler;
+            void *arg;
+        };
+
+        DRAM_ATTR std::array<IsrSlot, GPIO_NUM_MAX> isr_slots;
+
+        void IRAM_ATTR dispatchIsr(void *arg)
+        {
+            uint32_t pin = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(arg));
+#if GPIO_STATS_ENABLE
+            GpioStats::countInterrupt(pin);
+#endif
+#if GPIO_TRACE_ENABLE
+            GpioTraceRecorder::recordInterrupt(pin);
+#endif
+            isr_slots[pin].handler(isr_slots[pin].arg);
+        }
+#endif
     }
 
-    GPIOException::GPIOException(esp_err_t error) : ESPException(error) {}
+#if CONFIG_IDF_TARGET_LINUX
+    void simulateInterrupt(uint32_t pin)
+    {
+        if (pin < GPIO_NUM_MAX && isr_slots[pin].handler)
+        {
+            dispatchIsr(reinterpret_cast<void *>(static_cast<uintptr_t>(pin)));
+        }
+    }
+#endif
 
     esp_err_t isValidPin(uint32_t pin_num) noexcept
     {
-        if (pin_num >= GPIO_NUM_MAX)
+        if (pin_num >= GPIO_NUM_MAX || !((VALID_PINS >> pin_num) & 1))
         {
             return ESP_ERR_INVALID_ARG;
         }
 
-        for (auto num : INVALID_GPIOS)
+        return ESP_OK;
+    }
+
+    esp_err_t isValidPins(const uint32_t *pin_nums, size_t count) noexcept
+    {
+        uint64_t used = 0;
+        uint32_t out_of_range = 0;
+        for (size_t i = 0; i < count; i++)
         {
-            if (pin_num == num)
-            {
-                return ESP_ERR_INVALID_ARG;
-            }
+            out_of_range |= pin_nums[i] >= GPIO_NUM_MAX;
+            used |= 1ULL << (pin_nums[i] & 63);
+        }
+
+        if (out_of_range || (used & ~VALID_PINS))
+        {
+            return ESP_ERR_INVALID_ARG;
         }
 
         return ESP_OK;
@@ -59,6 +254,31 @@ namespace Components
         return ESP_OK;
     }
 
+    bool isPlainIoMuxPad(uint32_t pin_num) noexcept
+    {
+#if CONFIG_IDF_TARGET_LINUX
+        (void)pin_num;
+        (void)USB_PHY_PINS;
+        return false;
+#else
+#if !SOC_GPIO_SUPPORT_RTC_INDEPENDENT && SOC_RTCIO_INPUT_OUTPUT_SUPPORTED
+        if (rtc_gpio_is_valid_gpio(static_cast<gpio_num_t>(pin_num)))
+        {
+            return false;
+        }
+#endif
+#if CONFIG_IDF_TARGET_ESP32S2
+        // the driver swaps the two drive strength bits of GPIO17 and GPIO18
+        if (pin_num == 17 || pin_num == 18)
+        {
+            return false;
+        }
+#endif
+        // the driver also switches off the pull-up of the USB Serial/JTAG peripheral on D+
+        return !((USB_PHY_PINS >> pin_num) & 1);
+#endif
+    }
+
     GPIOPullMode GPIOPullMode::FLOATING()
     {
         return GPIOPullMode(GPIO_FLOATING);
@@ -84,6 +304,31 @@ namespace Components
         return GPIOWakeupIntrType(GPIO_INTR_HIGH_LEVEL);
     }
 
+    GPIOIntrType GPIOIntrType::POSEDGE()
+    {
+        return GPIOIntrType(GPIO_INTR_POSEDGE);
+    }
+
+    GPIOIntrType GPIOIntrType::NEGEDGE()
+    {
+        return GPIOIntrType(GPIO_INTR_NEGEDGE);
+    }
+
+    GPIOIntrType GPIOIntrType::ANYEDGE()
+    {
+        return GPIOIntrType(GPIO_INTR_ANYEDGE);
+    }
+
+    GPIOIntrType GPIOIntrType::LOW_LEVEL()
+    {
+        return GPIOIntrType(GPIO_INTR_LOW_LEVEL);
+    }
+
+    GPIOIntrType GPIOIntrType::HIGH_LEVEL()
+    {
+        return GPIOIntrType(GPIO_INTR_HIGH_LEVEL);
+    }
+
     GPIODriveStrength GPIODriveStrength::DEFAULT()
     {
         return MEDIUM();
@@ -111,95 +356,178 @@ namespace Components
 
     GPIO::GPIO(GPIONum num) : gpio_num(num)
     {
-        GPIO_CHECK_THROW(gpio_reset_pin(gpio_num.get_value<gpio_num_t>()));
+        GPIO_CHECK_THROW(resetPin(gpio_num.get_value<gpio_num_t>()));
     }
 
     void GPIO::holdEnable()
     {
-        GPIO_CHECK_THROW(gpio_hold_en(gpio_num.get_value<gpio_num_t>()));
+        GPIO_CHECK_THROW(setPinHold(gpio_num.get_value<gpio_num_t>(), true));
+        GpioDiagnostics::noteHold(gpio_num.get_value<uint32_t>(), true);
     }
 
     void GPIO::holdDisable()
     {
-        GPIO_CHECK_THROW(gpio_hold_dis(gpio_num.get_value<gpio_num_t>()));
+        GPIO_CHECK_THROW(setPinHold(gpio_num.get_value<gpio_num_t>(), false));
+        GpioDiagnostics::noteHold(gpio_num.get_value<uint32_t>(), false);
     }
 
     void GPIO::setDriveStrength(GPIODriveStrength strength)
     {
-        GPIO_CHECK_THROW(gpio_set_drive_capability(gpio_num.get_value<gpio_num_t>(),
-                                                   strength.get_value<gpio_drive_cap_t>()));
+        GPIO_CHECK_THROW(setPinDriveStrength(gpio_num.get_value<gpio_num_t>(), strength.get_value<gpio_drive_cap_t>()));
     }
 
     PinOutput::PinOutput(GPIONum num) : GPIO(num)
     {
-        GPIO_CHECK_THROW(gpio_set_direction(gpio_num.get_value<gpio_num_t>(), GPIO_MODE_OUTPUT));
+        GPIO_CHECK_THROW(setPinDirection(gpio_num.get_value<gpio_num_t>(), GPIO_MODE_OUTPUT));
     }
 
     void PinOutput::setHigh()
     {
-        GPIO_CHECK_THROW(gpio_set_level(gpio_num.get_value<gpio_num_t>(), 1));
+        GPIO_CHECK_THROW(setPinLevel(gpio_num.get_value<gpio_num_t>(), 1));
     }
 
     void PinOutput::setLow()
     {
-        GPIO_CHECK_THROW(gpio_set_level(gpio_num.get_value<gpio_num_t>(), 0));
+        GPIO_CHECK_THROW(setPinLevel(gpio_num.get_value<gpio_num_t>(), 0));
+    }
+
+    PinInput PinOutput::intoInput() &&
+    {
+        GPIO_CHECK_THROW(setPinDirection(gpio_num.get_value<gpio_num_t>(), GPIO_MODE_INPUT));
+        return PinInput(gpio_num, Reconfigure());
+    }
+
+    PinOutputInput PinOutput::intoOutputInput() &&
+    {
+        // open drain first, writing 1 while still push-pull would drive the line high
+        GPIO_CHECK_THROW(setPinDirection(gpio_num.get_value<gpio_num_t>(), GPIO_MODE_INPUT_OUTPUT_OD));
+        GPIO_CHECK_THROW(setPinLevel(gpio_num.get_value<gpio_num_t>(), 1));
+        return PinOutputInput(gpio_num, Reconfigure());
     }
 
     GPIODriveStrength GPIO::getDriveStrength()
     {
         gpio_drive_cap_t strength;
-        GPIO_CHECK_THROW(gpio_get_drive_capability(gpio_num.get_value<gpio_num_t>(), &strength));
+        GPIO_CHECK_THROW(getPinDriveStrength(gpio_num.get_value<gpio_num_t>(), &strength));
         return GPIODriveStrength(static_cast<uint32_t>(strength));
     }
 
     PinInput::PinInput(GPIONum num) : GPIO(num)
     {
-        GPIO_CHECK_THROW(gpio_set_direction(gpio_num.get_value<gpio_num_t>(), GPIO_MODE_INPUT));
+        GPIO_CHECK_THROW(setPinDirection(gpio_num.get_value<gpio_num_t>(), GPIO_MODE_INPUT));
     }
 
     GPIOLevel PinInput::getLevel() const noexcept
     {
-        int level = gpio_get_level(gpio_num.get_value<gpio_num_t>());
-        if (level)
-        {
-            return GPIOLevel::HIGH;
-        }
-        else
+        GPIOLevel level;
+#if CONFIG_IDF_TARGET_LINUX
+        if (!GpioTraceReplayer::serveRead(gpio_num.get_value<uint32_t>(), level))
+#endif
         {
-            return GPIOLevel::LOW;
+            level = getPinLevel(gpio_num.get_value<gpio_num_t>()) ? GPIOLevel::HIGH : GPIOLevel::LOW;
         }
+#if GPIO_TRACE_ENABLE
+        GpioTraceRecorder::recordRead(gpio_num.get_value<uint32_t>(), level);
+#endif
+        return level;
     }
 
     void PinInput::setPullMode(GPIOPullMode mode)
     {
-        GPIO_CHECK_THROW(gpio_set_pull_mode(gpio_num.get_value<gpio_num_t>(),
-                                            mode.get_value<gpio_pull_mode_t>()));
+        GPIO_CHECK_THROW(setPinPull(gpio_num.get_value<gpio_num_t>(), mode.get_value<gpio_pull_mode_t>()));
     }
 
     void PinInput::wakeupEnable(GPIOWakeupIntrType interrupt_type)
     {
-        GPIO_CHECK_THROW(gpio_wakeup_enable(gpio_num.get_value<gpio_num_t>(),
-                                            interrupt_type.get_value<gpio_int_type_t>()));
+        GPIO_CHECK_THROW(setPinWakeup(gpio_num.get_value<gpio_num_t>(), interrupt_type.get_value<gpio_int_type_t>(), true));
     }
 
     void PinInput::wakeupDisable()
     {
-        GPIO_CHECK_THROW(gpio_wakeup_disable(gpio_num.get_value<gpio_num_t>()));
+        GPIO_CHECK_THROW(setPinWakeup(gpio_num.get_value<gpio_num_t>(), GPIO_INTR_DISABLE, false));
+    }
+
+    void PinInput::interruptEnable(GPIOIntrType type, GPIOISRHandler handler, void *arg)
+    {
+#if CONFIG_IDF_TARGET_LINUX
+        // there is no interrupt controller on the host, simulateInterrupt() calls the slot directly
+        (void)type;
+        isr_slots[gpio_num.get_value<uint32_t>()] = IsrSlot{handler, arg};
+#else
+        esp_err_t service_result = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+        if (service_result != ESP_ERR_INVALID_STATE)
+        {
+            GPIO_CHECK_THROW(service_result);
+        }
+
+        // a handler may be installed already, the ISR must not run while its slot is rewritten
+        GPIO_CHECK_THROW(gpio_intr_disable(gpio_num.get_value<gpio_num_t>()));
+        GPIO_CHECK_THROW(gpio_set_intr_type(gpio_num.get_value<gpio_num_t>(), type.get_value<gpio_int_type_t>()));
+#if GPIO_ISR_DISPATCH
+        uint32_t pin = gpio_num.get_value<uint32_t>();
+        isr_slots[pin] = IsrSlot{handler, arg};
+        GPIO_CHECK_THROW(gpio_isr_handler_add(gpio_num.get_value<gpio_num_t>(),
+                                              dispatchIsr,
+                                              reinterpret_cast<void *>(static_cast<uintptr_t>(pin))));
+#else
+        GPIO_CHECK_THROW(gpio_isr_handler_add(gpio_num.get_value<gpio_num_t>(), handler, arg));
+#endif
+        GPIO_CHECK_THROW(gpio_intr_enable(gpio_num.get_value<gpio_num_t>()));
+#endif
+    }
+
+    void PinInput::interruptDisable()
+    {
+#if !CONFIG_IDF_TARGET_LINUX
+        GPIO_CHECK_THROW(gpio_intr_disable(gpio_num.get_value<gpio_num_t>()));
+        GPIO_CHECK_THROW(gpio_isr_handler_remove(gpio_num.get_value<gpio_num_t>()));
+#endif
+#if GPIO_ISR_DISPATCH
+        isr_slots[gpio_num.get_value<uint32_t>()] = IsrSlot{};
+#endif
+    }
+
+    PinOutput PinInput::intoOutput(GPIOLevel level) &&
+    {
+        GPIO_CHECK_THROW(setPinLevel(gpio_num.get_value<gpio_num_t>(), level == GPIOLevel::HIGH ? 1 : 0));
+        GPIO_CHECK_THROW(setPinDirection(gpio_num.get_value<gpio_num_t>(), GPIO_MODE_OUTPUT));
+        return PinOutput(gpio_num, Reconfigure());
+    }
+
+    PinOutputInput PinInput::intoOutputInput() &&
+    {
+        // the latch is set while the output is still disabled, enabling open drain with a 0 latch would pull low
+        GPIO_CHECK_THROW(setPinLevel(gpio_num.get_value<gpio_num_t>(), 1));
+        GPIO_CHECK_THROW(setPinDirection(gpio_num.get_value<gpio_num_t>(), GPIO_MODE_INPUT_OUTPUT_OD));
+        return PinOutputInput(gpio_num, Reconfigure());
     }
 
     PinOutputInput::PinOutputInput(GPIONum num) : PinInput(num)
     {
-        GPIO_CHECK_THROW(gpio_set_direction(gpio_num.get_value<gpio_num_t>(), GPIO_MODE_INPUT_OUTPUT_OD));
+        GPIO_CHECK_THROW(setPinDirection(gpio_num.get_value<gpio_num_t>(), GPIO_MODE_INPUT_OUTPUT_OD));
     }
 
     void PinOutputInput::setFloating()
     {
-        GPIO_CHECK_THROW(gpio_set_level(gpio_num.get_value<gpio_num_t>(), 1));
+        GPIO_CHECK_THROW(setPinLevel(gpio_num.get_value<gpio_num_t>(), 1));
     }
 
     void PinOutputInput::setLow()
     {
-        GPIO_CHECK_THROW(gpio_set_level(gpio_num.get_value<gpio_num_t>(), 0));
+        GPIO_CHECK_THROW(setPinLevel(gpio_num.get_value<gpio_num_t>(), 0));
+    }
+
+    PinInput PinOutputInput::intoInput() &&
+    {
+        GPIO_CHECK_THROW(setPinDirection(gpio_num.get_value<gpio_num_t>(), GPIO_MODE_INPUT));
+        return PinInput(gpio_num, Reconfigure());
+    }
+
+    PinOutput PinOutputInput::intoOutput(GPIOLevel level) &&
+    {
+        GPIO_CHECK_THROW(setPinLevel(gpio_num.get_value<gpio_num_t>(), level == GPIOLevel::HIGH ? 1 : 0));
+        GPIO_CHECK_THROW(setPinDirection(gpio_num.get_value<gpio_num_t>(), GPIO_MODE_OUTPUT));
+        return PinOutput(gpio_num, Reconfigure());
     }
 
 }
@@ -0,0 +1,220 @@
+#if __cpp_exceptions
+
+#include <array>
+#include <chrono>
+#include "driver/gpio.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_cpu.h"
+#include "esp_rom_sys.h"
+#endif
+#include "GpioClock.hpp"
+#include "Gpio.hpp"
+
+namespace Components
+{
+    namespace GpioClock
+    {
+#if CONFIG_IDF_TARGET_LINUX
+        namespace
+        {
+            struct VirtualTimer
+            {
+                TimerCallback callback;
+                void *arg;
+                uint64_t period_ns;
+                uint64_t due_ns;
+            };
+
+            bool virtual_time = false;
+            bool firing = false;
+            uint64_t virtual_ns = 0;
+            uint32_t auto_advance_ns = 0;
+            std::array<VirtualTimer, MAX_VIRTUAL_TIMERS> timers = {};
+
+            uint64_t realNs() noexcept
+            {
+                auto now = std::chrono::steady_clock::now().time_since_epoch();
+                return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+            }
+
+            /*
+             * The running timer due first, or nullptr.
+             */
+            VirtualTimer *nextTimer() noexcept
+            {
+                VirtualTimer *next = nullptr;
+                for (VirtualTimer &timer : timers)
+                {
+                    if (timer.callback && (!next || timer.due_ns < next->due_ns))
+                    {
+                        next = &timer;
+                    }
+                }
+                return next;
+            }
+
+            void fire(VirtualTimer &timer)
+            {
+                if (virtual_ns < timer.due_ns)
+                {
+                    virtual_ns = timer.due_ns;
+                }
+                timer.due_ns += timer.period_ns;
+
+                firing = true;
+                try
+                {
+                    timer.callback(timer.arg);
+                }
+                catch (...)
+                {
+                    firing = false;
+                    throw;
+                }
+                firing = false;
+            }
+
+            uint64_t virtualNow() noexcept
+            {
+                if (auto_advance_ns)
+                {
+                    virtual_ns += auto_advance_ns;
+                }
+                return virtual_ns;
+            }
+        }
+
+        void setVirtual(bool enable) noexcept
+        {
+            if (enable && !virtual_time)
+            {
+                virtual_ns = realNs();
+            }
+            virtual_time = enable;
+        }
+
+        bool isVirtual() noexcept
+        {
+            return virtual_time;
+        }
+
+        uint64_t nowNs() noexcept
+        {
+            return virtual_time ? virtualNow() : realNs();
+        }
+
+        void advanceNs(uint64_t ns)
+        {
+            uint64_t target = virtual_ns + ns;
+            if (!firing)
+            {
+                VirtualTimer *timer;
+                while ((timer = nextTimer()) && timer->due_ns <= target)
+                {
+                    fire(*timer);
+                }
+            }
+            if (virtual_ns < target)
+            {
+                virtual_ns = target;
+            }
+        }
+
+        bool runNextTimer()
+        {
+            VirtualTimer *timer = nextTimer();
+            if (!timer || firing)
+            {
+                return false;
+            }
+            fire(*timer);
+            return true;
+        }
+
+        void skipNs(uint64_t ns) noexcept
+        {
+            virtual_ns += ns;
+        }
+
+        void setAutoAdvanceNs(uint32_t ns) noexcept
+        {
+            auto_advance_ns = ns;
+        }
+
+        int startTimer(TimerCallback callback, void *arg, uint64_t period_us)
+        {
+            if (!callback || period_us == 0)
+            {
+                throw GPIOException(ESP_ERR_INVALID_ARG);
+            }
+
+            for (size_t i = 0; i < timers.size(); i++)
+            {
+                if (!timers[i].callback)
+                {
+                    uint64_t period_ns = period_us * 1000;
+                    timers[i] = VirtualTimer{callback, arg, period_ns, virtual_ns + period_ns};
+                    return static_cast<int>(i);
+                }
+            }
+            throw GPIOException(ESP_ERR_NO_MEM);
+        }
+
+        void stopTimer(int timer) noexcept
+        {
+            if (timer >= 0 && static_cast<size_t>(timer) < timers.size())
+            {
+                timers[timer] = VirtualTimer{};
+            }
+        }
+#endif
+
+        int64_t IRAM_ATTR nowUs() noexcept
+        {
+#if CONFIG_IDF_TARGET_LINUX
+            if (virtual_time)
+            {
+                return static_cast<int64_t>(virtualNow() / 1000);
+            }
+#endif
+            return esp_timer_get_time();
+        }
+
+        uint32_t IRAM_ATTR cycles() noexcept
+        {
+#if CONFIG_IDF_TARGET_LINUX
+            return static_cast<uint32_t>(virtual_time ? virtualNow() : realNs());
+#else
+            return static_cast<uint32_t>(esp_cpu_get_cycle_count());
+#endif
+        }
+
+        uint32_t IRAM_ATTR coreId() noexcept
+        {
+#if CONFIG_IDF_TARGET_LINUX
+            return 0;
+#else
+            return static_cast<uint32_t>(esp_cpu_get_core_id());
+#endif
+        }
+
+        void IRAM_ATTR delayUs(uint32_t us) noexcept
+        {
+#if CONFIG_IDF_TARGET_LINUX
+            if (virtual_time)
+            {
+                skipNs(static_cast<uint64_t>(us) * 1000);
+                return;
+            }
+            uint64_t end = realNs() + static_cast<uint64_t>(us) * 1000;
+            while (realNs() < end) { }
+#else
+            esp_rom_delay_us(us);
+#endif
+        }
+    }
+}
+
+#endif
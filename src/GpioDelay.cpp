@@ -0,0 +1,152 @@
+#if __cpp_exceptions
+
+#include "esp_attr.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_rom_sys.h"
+#endif
+#include "GpioDelay.hpp"
+#include "GpioClock.hpp"
+
+namespace Components
+{
+    namespace GpioDelay
+    {
+        namespace
+        {
+            constexpr int64_t CALIBRATION_US = 1000;
+            constexpr int OVERHEAD_RUNS = 8;
+
+            /*
+             * measured_ticks is the rate measured against esp_timer while the ROM reported calibrated_rom_ticks.
+             * ticks is the rate used for delays, rescaled whenever the ROM reports a frequency other than
+             * last_rom_ticks. Zero means not calibrated.
+             */
+            DRAM_ATTR uint32_t measured_ticks = 0;
+            DRAM_ATTR uint32_t calibrated_rom_ticks = 0;
+            DRAM_ATTR uint32_t last_rom_ticks = 0;
+            DRAM_ATTR uint32_t ticks = 0;
+            DRAM_ATTR uint32_t overhead = 0;
+
+            uint32_t IRAM_ATTR romTicks() noexcept
+            {
+#if CONFIG_IDF_TARGET_LINUX
+                return 1000;
+#else
+                return esp_rom_get_cpu_ticks_per_us();
+#endif
+            }
+
+            uint32_t IRAM_ATTR currentTicks() noexcept
+            {
+                uint32_t rom = romTicks();
+                if (rom != last_rom_ticks)
+                {
+                    ticks = measured_ticks * rom / calibrated_rom_ticks;
+                    last_rom_ticks = rom;
+                }
+                return ticks;
+            }
+
+            void IRAM_ATTR wait(uint32_t start, uint32_t cycles) noexcept
+            {
+#if CONFIG_IDF_TARGET_LINUX
+                if (GpioClock::isVirtual())
+                {
+                    uint32_t elapsed = GpioClock::cycles() - start;
+                    GpioClock::skipNs(elapsed < cycles ? cycles - elapsed : 0);
+                    return;
+                }
+#endif
+                while (GpioClock::cycles() - start < cycles) { }
+            }
+        }
+
+        void calibrate() noexcept
+        {
+#if CONFIG_IDF_TARGET_LINUX
+            uint32_t rate = 1000;
+#else
+            int64_t start_us = GpioClock::nowUs();
+            uint32_t start_cycles = GpioClock::cycles();
+            int64_t end_us;
+            do
+            {
+                end_us = GpioClock::nowUs();
+            }
+            while (end_us - start_us < CALIBRATION_US);
+            uint32_t elapsed = GpioClock::cycles() - start_cycles;
+            uint32_t elapsed_us = static_cast<uint32_t>(end_us - start_us);
+            uint32_t rate = (elapsed + elapsed_us / 2) / elapsed_us;
+#endif
+            calibrated_rom_ticks = romTicks();
+            last_rom_ticks = calibrated_rom_ticks;
+            measured_ticks = rate;
+            ticks = rate;
+
+            overhead = 0;
+            uint32_t fastest = UINT32_MAX;
+            for (int i = 0; i < OVERHEAD_RUNS; i++)
+            {
+                uint32_t start = GpioClock::cycles();
+                delayCycles(0);
+                uint32_t taken = GpioClock::cycles() - start;
+                fastest = taken < fastest ? taken : fastest;
+            }
+            overhead = fastest;
+        }
+
+        uint32_t cyclesPerUs() noexcept
+        {
+            if (measured_ticks == 0)
+            {
+                calibrate();
+            }
+            return currentTicks();
+        }
+
+        uint32_t overheadCycles() noexcept
+        {
+            return overhead;
+        }
+
+        void IRAM_ATTR delayCycles(uint32_t cycles) noexcept
+        {
+            uint32_t start = GpioClock::cycles();
+            if (cycles > overhead)
+            {
+                wait(start, cycles - overhead);
+            }
+        }
+
+        void IRAM_ATTR delayNs(uint32_t ns) noexcept
+        {
+            uint32_t start = GpioClock::cycles();
+            if (measured_ticks == 0)
+            {
+                calibrate();
+            }
+            uint32_t rate = currentTicks();
+
+            // split to stay within 32 bit arithmetic, 64 bit division is not IRAM resident
+            uint32_t cycles = (ns / 1000) * rate + (ns % 1000) * rate / 1000;
+            if (cycles > overhead)
+            {
+                wait(start, cycles - overhead);
+            }
+        }
+
+        void measureAccuracy(uint32_t ns, size_t iterations, LatencyHistogram &errors) noexcept
+        {
+            uint32_t rate = cyclesPerUs();
+            for (size_t i = 0; i < iterations; i++)
+            {
+                uint32_t start = GpioClock::cycles();
+                delayNs(ns);
+                uint32_t taken = static_cast<uint32_t>((GpioClock::cycles() - start) * uint64_t(1000) / rate);
+                errors.record(taken > ns ? taken - ns : ns - taken);
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,161 @@
+#if __cpp_exceptions
+
+#include <array>
+#include <cstdio>
+#include "esp_attr.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "soc/gpio_periph.h"
+#include "soc/gpio_reg.h"
+#include "soc/io_mux_reg.h"
+#include "soc/soc.h"
+#include "soc/soc_caps.h"
+#if SOC_RTCIO_INPUT_OUTPUT_SUPPORTED && !SOC_GPIO_SUPPORT_RTC_INDEPENDENT
+#include "soc/rtc_io_periph.h"
+#endif
+#endif
+#include "GpioDiagnostics.hpp"
+#include "GpioBanks.hpp"
+
+namespace Components
+{
+    namespace GpioDiagnostics
+    {
+        namespace
+        {
+            // the GPIO_PINn and GPIO_FUNCn_OUT_SEL_CFG registers of consecutive pins are consecutive words
+            constexpr uint32_t PIN_REGISTER_STRIDE = 4;
+
+            constexpr const char *DIRECTION_NAMES[] = {"off", "in", "out", "in/out"};
+
+            DRAM_ATTR GpioMask held;
+
+#if !CONFIG_IDF_TARGET_LINUX
+            /*
+             * Pull and drive of \c pin, from its IO MUX register \c mux or, for RTC IO pads, their RTC IO register.
+             */
+            void readPadConfig(uint32_t pin, uint32_t mux, GPIOPinState &state) noexcept
+            {
+#if SOC_RTCIO_INPUT_OUTPUT_SUPPORTED && !SOC_GPIO_SUPPORT_RTC_INDEPENDENT
+                int rtc_num = rtc_io_num_map[pin];
+                if (!isPlainIoMuxPad(pin) && rtc_num >= 0)
+                {
+                    const rtc_io_desc_t &desc = rtc_io_desc[rtc_num];
+                    uint32_t rtc = REG_READ(desc.reg);
+                    uint32_t drive = (rtc >> desc.drv_s) & desc.drv_v;
+#if CONFIG_IDF_TARGET_ESP32S2
+                    // the two drive bits are swapped on GPIO17 and GPIO18
+                    if (pin == 17 || pin == 18)
+                    {
+                        drive = ((drive & 1) << 1) | ((drive >> 1) & 1);
+                    }
+#endif
+                    state.pull_up = (rtc & desc.pullup) != 0;
+                    state.pull_down = (rtc & desc.pulldown) != 0;
+                    state.drive = drive;
+                    return;
+                }
+#endif
+                state.pull_up = (mux & FUN_PU) != 0;
+                state.pull_down = (mux & FUN_PD) != 0;
+                state.drive = (mux >> FUN_DRV_S) & FUN_DRV_V;
+            }
+#endif
+        }
+
+        size_t snapshot(GPIOPinState *states, size_t max_states, const GpioMask &pins) noexcept
+        {
+            std::array<uint32_t, GpioMask::BANK_COUNT> output = {};
+            std::array<uint32_t, GpioMask::BANK_COUNT> enable = {};
+            std::array<uint32_t, GpioMask::BANK_COUNT> input = {};
+            for (size_t bank = 0; bank < GpioMask::BANK_COUNT; bank++)
+            {
+                if (pins.banks[bank])
+                {
+                    output[bank] = GpioBanks::readOutputBank(bank);
+                    enable[bank] = GpioBanks::readEnableBank(bank);
+                    input[bank] = GpioBanks::readBank(bank);
+                }
+            }
+
+            size_t count = 0;
+            for (uint32_t pin : pins & GpioMask::valid())
+            {
+                if (count >= max_states)
+                {
+                    break;
+                }
+#if !CONFIG_IDF_TARGET_LINUX
+                if (!GPIO_PIN_MUX_REG[pin])
+                {
+                    // a pin number without a pad
+                    continue;
+                }
+#endif
+
+                size_t bank = pin / GpioMask::BANK_BITS;
+                uint32_t bit = 1u << (pin % GpioMask::BANK_BITS);
+                bool output_enabled = enable[bank] & bit;
+                bool input_enabled;
+
+                GPIOPinState &state = states[count++];
+                state = GPIOPinState{};
+                state.num = pin;
+                state.input_level = (input[bank] & bit) != 0;
+                state.output_level = (output[bank] & bit) != 0;
+                state.hold = held.contains(pin);
+
+#if CONFIG_IDF_TARGET_LINUX
+                input_enabled = !output_enabled;
+#else
+                uint32_t mux = REG_READ(GPIO_PIN_MUX_REG[pin]);
+                uint32_t pin_config = REG_READ(GPIO_PIN0_REG + pin * PIN_REGISTER_STRIDE);
+                uint32_t out_select = REG_READ(GPIO_FUNC0_OUT_SEL_CFG_REG + pin * PIN_REGISTER_STRIDE);
+
+                input_enabled = mux & FUN_IE;
+                readPadConfig(pin, mux, state);
+                state.function = (mux >> MCU_SEL_S) & MCU_SEL_V;
+                state.open_drain = (pin_config >> GPIO_PIN0_PAD_DRIVER_S) & 1;
+                state.intr_type = (pin_config >> GPIO_PIN0_INT_TYPE_S) & GPIO_PIN0_INT_TYPE_V;
+                state.out_signal = (out_select >> GPIO_FUNC0_OUT_SEL_S) & GPIO_FUNC0_OUT_SEL_V;
+#endif
+
+                state.direction = static_cast<uint32_t>(input_enabled) | (static_cast<uint32_t>(output_enabled) << 1);
+            }
+
+            return count;
+        }
+
+        int format(const GPIOPinState &state, char *buffer, size_t size) noexcept
+        {
+            return snprintf(buffer,
+                            size,
+                            "GPIO%-2u %-6s od=%u in=%u out=%u pu=%u pd=%u drv=%u hold=%u fun=%u intr=%u sig=%u",
+                            static_cast<unsigned>(state.num),
+                            DIRECTION_NAMES[state.direction],
+                            static_cast<unsigned>(state.open_drain),
+                            static_cast<unsigned>(state.input_level),
+                            static_cast<unsigned>(state.output_level),
+                            static_cast<unsigned>(state.pull_up),
+                            static_cast<unsigned>(state.pull_down),
+                            static_cast<unsigned>(state.drive),
+                            static_cast<unsigned>(state.hold),
+                            static_cast<unsigned>(state.function),
+                            static_cast<unsigned>(state.intr_type),
+                            static_cast<unsigned>(state.out_signal));
+        }
+
+        void noteHold(uint32_t pin, bool enabled) noexcept
+        {
+            if (enabled)
+            {
+                held.set(pin);
+            }
+            else
+            {
+                held.reset(pin);
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,152 @@
+#if __cpp_exceptions
+
+#include "esp_attr.h"
+#include "GpioLatency.hpp"
+
+namespace Components
+{
+
+    LatencyHistogram::LatencyHistogram() noexcept
+    {
+        reset();
+    }
+
+    void IRAM_ATTR LatencyHistogram::record(uint32_t latency) noexcept
+    {
+        buckets[bucketOf(latency)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void LatencyHistogram::merge(const LatencyHistogram &other) noexcept
+    {
+        for (size_t i = 0; i < BUCKET_COUNT; i++)
+        {
+            buckets[i].fetch_add(other.buckets[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+    }
+
+    void LatencyHistogram::reset() noexcept
+    {
+        for (auto &bucket : buckets)
+        {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    uint32_t LatencyHistogram::count() const noexcept
+    {
+        uint32_t total = 0;
+        for (const auto &bucket : buckets)
+        {
+            total += bucket.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    uint32_t LatencyHistogram::percentile(float percent) const noexcept
+    {
+        uint32_t total = count();
+        if (total == 0)
+        {
+            return 0;
+        }
+
+        if (percent < 0.0f)
+        {
+            percent = 0.0f;
+        }
+        else if (percent > 100.0f)
+        {
+            percent = 100.0f;
+        }
+
+        uint32_t rank = static_cast<uint32_t>(static_cast<float>(total) * percent / 100.0f + 0.5f);
+        if (rank == 0)
+        {
+            rank = 1;
+        }
+
+        uint32_t seen = 0;
+        for (size_t i = 0; i < BUCKET_COUNT; i++)
+        {
+            seen += buckets[i].load(std::memory_order_relaxed);
+            if (seen >= rank)
+            {
+                return upperBoundOf(i);
+            }
+        }
+        return upperBoundOf(BUCKET_COUNT - 1);
+    }
+
+    InterruptLatencyProbe::InterruptLatencyProbe() noexcept
+        : handler(nullptr), handler_arg(nullptr), entry_us(NO_PENDING_ENTRY) {}
+
+    void InterruptLatencyProbe::attach(PinInput &pin, GPIOIntrType type, GPIOISRHandler isr_handler, void *arg)
+    {
+        handler = isr_handler;
+        handler_arg = arg;
+        pin.interruptEnable(type, isrTrampoline, this);
+    }
+
+    void IRAM_ATTR InterruptLatencyProbe::isrEntry() noexcept
+    {
+        entry_us.store(GpioClock::nowUs(), std::memory_order_release);
+    }
+
+    void IRAM_ATTR InterruptLatencyProbe::dispatched() noexcept
+    {
+        int64_t entry = entry_us.exchange(NO_PENDING_ENTRY, std::memory_order_acq_rel);
+        if (entry == NO_PENDING_ENTRY)
+        {
+            return;
+        }
+
+        int64_t latency = GpioClock::nowUs() - entry;
+        if (latency < 0)
+        {
+            latency = 0;
+        }
+        if (latency > LatencyHistogram::MAX_VALUE_US)
+        {
+            latency = LatencyHistogram::MAX_VALUE_US;
+        }
+        per_core[GpioClock::coreId()].record(static_cast<uint32_t>(latency));
+    }
+
+    void InterruptLatencyProbe::snapshot(LatencyHistogram &result) const noexcept
+    {
+        result.reset();
+        for (const auto &histogram : per_core)
+        {
+            result.merge(histogram);
+        }
+    }
+
+    uint32_t InterruptLatencyProbe::percentile(float percent) const noexcept
+    {
+        LatencyHistogram merged;
+        snapshot(merged);
+        return merged.percentile(percent);
+    }
+
+    void InterruptLatencyProbe::reset() noexcept
+    {
+        for (auto &histogram : per_core)
+        {
+            histogram.reset();
+        }
+        entry_us.store(NO_PENDING_ENTRY, std::memory_order_relaxed);
+    }
+
+    void IRAM_ATTR InterruptLatencyProbe::isrTrampoline(void *arg)
+    {
+        auto *probe = static_cast<InterruptLatencyProbe *>(arg);
+        probe->isrEntry();
+        if (probe->handler)
+        {
+            probe->handler(probe->handler_arg);
+        }
+    }
+
+}
+
+#endif
@@ -0,0 +1,57 @@
+#if __cpp_exceptions
+
+#include "esp_attr.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_pm.h"
+#endif
+#include "GpioPowerLock.hpp"
+
+namespace Components
+{
+
+#define GPIO_CHECK_THROW(err) CHECK_THROW_SPECIFIC((err), GPIOException)
+
+    GpioPowerLock::GpioPowerLock(const char *name) : handle(nullptr)
+    {
+#if !CONFIG_IDF_TARGET_LINUX
+        esp_err_t result = esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, name, &handle);
+
+        // without power management there is nothing to lock
+        if (result != ESP_ERR_NOT_SUPPORTED)
+        {
+            GPIO_CHECK_THROW(result);
+        }
+#else
+        (void)name;
+#endif
+    }
+
+    GpioPowerLock &GpioPowerLock::timing()
+    {
+        static GpioPowerLock lock("gpio_timing");
+        return lock;
+    }
+
+    void IRAM_ATTR GpioPowerLock::acquire() noexcept
+    {
+#if !CONFIG_IDF_TARGET_LINUX
+        if (handle)
+        {
+            esp_pm_lock_acquire(handle);
+        }
+#endif
+    }
+
+    void IRAM_ATTR GpioPowerLock::release() noexcept
+    {
+#if !CONFIG_IDF_TARGET_LINUX
+        if (handle)
+        {
+            esp_pm_lock_release(handle);
+        }
+#endif
+    }
+
+}
+
+#endif
@@ -0,0 +1,77 @@
+#if __cpp_exceptions
+
+#include <array>
+#include <atomic>
+#include "driver/gpio.h"
+#include "esp_attr.h"
+#include "GpioStats.hpp"
+#include "GpioMask.hpp"
+
+namespace Components
+{
+    namespace GpioStats
+    {
+        namespace
+        {
+            struct AtomicCounters
+            {
+                std::atomic<uint32_t> writes;
+                std::atomic<uint32_t> toggles;
+                std::atomic<uint32_t> interrupts;
+            };
+
+            DRAM_ATTR std::array<AtomicCounters, GPIO_NUM_MAX> counters;
+            DRAM_ATTR std::array<std::atomic<uint32_t>, GpioMask::BANK_COUNT> written_levels;
+            DRAM_ATTR std::atomic<uint32_t> error_count;
+        }
+
+        void IRAM_ATTR countWrite(uint32_t pin, bool level) noexcept
+        {
+            std::atomic<uint32_t> &levels = written_levels[pin / GpioMask::BANK_BITS];
+            uint32_t bit = 1u << (pin % GpioMask::BANK_BITS);
+            uint32_t before = level ? levels.fetch_or(bit, std::memory_order_relaxed)
+                                    : levels.fetch_and(~bit, std::memory_order_relaxed);
+
+            counters[pin].writes.fetch_add(1, std::memory_order_relaxed);
+            if (((before & bit) != 0) != level)
+            {
+                counters[pin].toggles.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        void IRAM_ATTR countInterrupt(uint32_t pin) noexcept
+        {
+            counters[pin].interrupts.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void IRAM_ATTR countError() noexcept
+        {
+            error_count.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        GpioPinCounters read(uint32_t pin) noexcept
+        {
+            return GpioPinCounters{counters[pin].writes.load(std::memory_order_relaxed),
+                                   counters[pin].toggles.load(std::memory_order_relaxed),
+                                   counters[pin].interrupts.load(std::memory_order_relaxed)};
+        }
+
+        uint32_t errors() noexcept
+        {
+            return error_count.load(std::memory_order_relaxed);
+        }
+
+        void clear() noexcept
+        {
+            for (AtomicCounters &pin_counters : counters)
+            {
+                pin_counters.writes.store(0, std::memory_order_relaxed);
+                pin_counters.toggles.store(0, std::memory_order_relaxed);
+                pin_counters.interrupts.store(0, std::memory_order_relaxed);
+            }
+            error_count.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,162 @@
+#if __cpp_exceptions
+
+#include "GpioTelemetry.hpp"
+
+namespace Components
+{
+
+    namespace
+    {
+        /*
+         * Appends to a fixed buffer, remembers if anything didn't fit instead of failing on every call.
+         */
+        class Writer
+        {
+        public:
+            Writer(uint8_t *buffer, size_t size) noexcept : buffer(buffer), size(size), position(0), overflow(false) { }
+
+            void byte(uint8_t value) noexcept
+            {
+                if (position < size)
+                {
+                    buffer[position++] = value;
+                }
+                else
+                {
+                    overflow = true;
+                }
+            }
+
+            void varint(uint32_t value) noexcept
+            {
+                while (value >= 0x80)
+                {
+                    byte(static_cast<uint8_t>(value | 0x80));
+                    value >>= 7;
+                }
+                byte(static_cast<uint8_t>(value));
+            }
+
+            /*
+             * Reserve bytes which are filled in later, returns their position.
+             */
+            size_t skip(size_t bytes) noexcept
+            {
+                size_t start = position;
+                for (size_t i = 0; i < bytes; i++)
+                {
+                    byte(0);
+                }
+                return start;
+            }
+
+            size_t length() const noexcept
+            {
+                return overflow ? 0 : position;
+            }
+
+            uint8_t *data() noexcept
+            {
+                return buffer;
+            }
+
+        private:
+            uint8_t *buffer;
+            size_t size;
+            size_t position;
+            bool overflow;
+        };
+
+        constexpr float REPORTED_PERCENTILES[] = {50.f, 90.f, 99.f};
+    }
+
+    GpioTelemetry::GpioTelemetry(const GpioMask &pins) noexcept
+        : pins(pins & GpioMask::valid()),
+          latency(nullptr),
+          baseline(),
+          baseline_errors(0),
+          sequence(0),
+          has_baseline(false)
+    {
+    }
+
+    void GpioTelemetry::setLatency(const LatencyHistogram *histogram) noexcept
+    {
+        latency = histogram;
+    }
+
+    size_t GpioTelemetry::encode(uint8_t *buffer, size_t size, bool delta) noexcept
+    {
+        delta = delta && has_baseline;
+        uint8_t flags = (delta ? FLAG_DELTA : 0) | (latency ? FLAG_LATENCY : 0);
+
+        Writer writer(buffer, size);
+        writer.byte(FORMAT_VERSION);
+        writer.byte(flags);
+        writer.varint(sequence);
+
+        uint32_t errors = GpioStats::errors();
+        writer.varint(delta ? errors - baseline_errors : errors);
+
+        // the record count is only known afterwards, it always fits into one byte as GPIO_NUM_MAX < 128
+        static_assert(GPIO_NUM_MAX < 0x80);
+        size_t count_position = writer.skip(1);
+        uint8_t records = 0;
+
+        std::array<GpioPinCounters, GPIO_NUM_MAX> current;
+        for (uint32_t pin : pins)
+        {
+            current[pin] = GpioStats::read(pin);
+            GpioPinCounters value = current[pin];
+            if (delta)
+            {
+                value.writes -= baseline[pin].writes;
+                value.toggles -= baseline[pin].toggles;
+                value.interrupts -= baseline[pin].interrupts;
+            }
+            if (value.writes == 0 && value.toggles == 0 && value.interrupts == 0)
+            {
+                continue;
+            }
+
+            writer.byte(static_cast<uint8_t>(pin));
+            writer.varint(value.writes);
+            writer.varint(value.toggles);
+            writer.varint(value.interrupts);
+            records++;
+        }
+
+        if (latency)
+        {
+            writer.varint(latency->count());
+            for (float percent : REPORTED_PERCENTILES)
+            {
+                writer.varint(latency->percentile(percent));
+            }
+        }
+
+        size_t length = writer.length();
+        if (length == 0)
+        {
+            return 0;
+        }
+
+        writer.data()[count_position] = records;
+        for (uint32_t pin : pins)
+        {
+            baseline[pin] = current[pin];
+        }
+        baseline_errors = errors;
+        has_baseline = true;
+        sequence++;
+        return length;
+    }
+
+    void GpioTelemetry::resetBaseline() noexcept
+    {
+        has_baseline = false;
+    }
+
+}
+
+#endif
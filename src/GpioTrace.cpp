@@ -0,0 +1,297 @@
+#if __cpp_exceptions
+
+#include "esp_attr.h"
+#if CONFIG_IDF_TARGET_LINUX
+#include <mutex>
+#include "SimulatedGpio.hpp"
+#else
+#include "freertos/FreeRTOS.h"
+#endif
+#include "GpioTrace.hpp"
+#include "GpioBanks.hpp"
+#include "GpioClock.hpp"
+#include "GpioMask.hpp"
+
+namespace Components
+{
+
+    namespace
+    {
+        constexpr uint32_t PIN_SHIFT = 26;
+        constexpr uint32_t EVENT_SHIFT = 25;
+        constexpr uint32_t LEVEL_SHIFT = 24;
+
+        static_assert(GPIO_NUM_MAX <= GpioTraceRecorder::TIME_EXTENSION_PIN, "pin numbers have to fit into 6 bit");
+
+#if CONFIG_IDF_TARGET_LINUX
+        std::mutex trace_lock;
+#else
+        portMUX_TYPE trace_lock = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
+        DRAM_ATTR uint32_t *trace_buffer = nullptr;
+        DRAM_ATTR size_t trace_capacity = 0;
+        DRAM_ATTR size_t trace_size = 0;
+        DRAM_ATTR uint32_t drop_count = 0;
+        DRAM_ATTR int64_t last_time_us = 0;
+        DRAM_ATTR volatile bool recording = false;
+
+        void IRAM_ATTR lockTrace() noexcept
+        {
+#if CONFIG_IDF_TARGET_LINUX
+            trace_lock.lock();
+#else
+            portENTER_CRITICAL_SAFE(&trace_lock);
+#endif
+        }
+
+        void IRAM_ATTR unlockTrace() noexcept
+        {
+#if CONFIG_IDF_TARGET_LINUX
+            trace_lock.unlock();
+#else
+            portEXIT_CRITICAL_SAFE(&trace_lock);
+#endif
+        }
+
+#if CONFIG_IDF_TARGET_LINUX
+        GpioTraceReplayer *attached_replayer = nullptr;
+#endif
+    }
+
+    void GpioTraceRecorder::start(uint32_t *buffer, size_t words) noexcept
+    {
+        lockTrace();
+        trace_buffer = buffer;
+        trace_capacity = words;
+        trace_size = 0;
+        drop_count = 0;
+        last_time_us = GpioClock::nowUs();
+        recording = true;
+        unlockTrace();
+    }
+
+    void GpioTraceRecorder::stop() noexcept
+    {
+        recording = false;
+    }
+
+    size_t GpioTraceRecorder::size() noexcept
+    {
+        return trace_size;
+    }
+
+    uint32_t GpioTraceRecorder::dropped() noexcept
+    {
+        return drop_count;
+    }
+
+    void IRAM_ATTR GpioTraceRecorder::recordRead(uint32_t pin, GPIOLevel level) noexcept
+    {
+        if (recording)
+        {
+            record(pin, GpioTraceEvent::READ, level);
+        }
+    }
+
+    void IRAM_ATTR GpioTraceRecorder::recordInterrupt(uint32_t pin) noexcept
+    {
+        if (recording)
+        {
+            bool high = GpioBanks::readBank(pin / GpioMask::BANK_BITS) & (1u << (pin % GpioMask::BANK_BITS));
+            record(pin, GpioTraceEvent::INTERRUPT, high ? GPIOLevel::HIGH : GPIOLevel::LOW);
+        }
+    }
+
+    void IRAM_ATTR GpioTraceRecorder::record(uint32_t pin, GpioTraceEvent event, GPIOLevel level) noexcept
+    {
+        lockTrace();
+        if (recording)
+        {
+            int64_t now = GpioClock::nowUs();
+            uint64_t delta = static_cast<uint64_t>(now - last_time_us);
+            size_t extensions = static_cast<size_t>(delta / MAX_DELTA_US);
+
+            if (trace_size + extensions + 1 > trace_capacity)
+            {
+                drop_count++;
+            }
+            else
+            {
+                for (size_t i = 0; i < extensions; i++)
+                {
+                    trace_buffer[trace_size++] = (TIME_EXTENSION_PIN << PIN_SHIFT) | MAX_DELTA_US;
+                    delta -= MAX_DELTA_US;
+                }
+                trace_buffer[trace_size++] = (pin << PIN_SHIFT)
+                                             | (static_cast<uint32_t>(event) << EVENT_SHIFT)
+                                             | (static_cast<uint32_t>(level == GPIOLevel::HIGH) << LEVEL_SHIFT)
+                                             | static_cast<uint32_t>(delta);
+                last_time_us = now;
+            }
+        }
+        unlockTrace();
+    }
+
+    GpioTraceReader::GpioTraceReader(const uint32_t *words, size_t count) noexcept
+        : words(words), count(count), position(0), time_us(0)
+    {
+    }
+
+    bool GpioTraceReader::next(GpioTraceRecord &record) noexcept
+    {
+        while (position < count)
+        {
+            uint32_t word = words[position++];
+            uint32_t pin = word >> PIN_SHIFT;
+            time_us += word & GpioTraceRecorder::MAX_DELTA_US;
+            if (pin == GpioTraceRecorder::TIME_EXTENSION_PIN)
+            {
+                continue;
+            }
+
+            record.time_us = time_us;
+            record.pin = static_cast<uint8_t>(pin);
+            record.event = static_cast<GpioTraceEvent>((word >> EVENT_SHIFT) & 1);
+            record.level = (word >> LEVEL_SHIFT) & 1 ? GPIOLevel::HIGH : GPIOLevel::LOW;
+            return true;
+        }
+        return false;
+    }
+
+    bool GpioTraceReader::peek(GpioTraceRecord &record) const noexcept
+    {
+        GpioTraceReader copy = *this;
+        return copy.next(record);
+    }
+
+    void GpioTraceReader::rewind() noexcept
+    {
+        position = 0;
+        time_us = 0;
+    }
+
+#if CONFIG_IDF_TARGET_LINUX
+    GpioTraceReplayer::GpioTraceReplayer(const uint32_t *words, size_t count) noexcept
+        : reader(words, count), time_us(0), mismatch_count(0)
+    {
+    }
+
+    GpioTraceReplayer::~GpioTraceReplayer()
+    {
+        detach();
+    }
+
+    void GpioTraceReplayer::attach() noexcept
+    {
+        attached_replayer = this;
+    }
+
+    void GpioTraceReplayer::detach() noexcept
+    {
+        if (attached_replayer == this)
+        {
+            attached_replayer = nullptr;
+        }
+    }
+
+    bool GpioTraceReplayer::finished() const noexcept
+    {
+        GpioTraceRecord record;
+        return !reader.peek(record);
+    }
+
+    void GpioTraceReplayer::deliver(const GpioTraceRecord &record)
+    {
+        if (GpioClock::isVirtual() && record.time_us > time_us)
+        {
+            GpioClock::advanceUs(record.time_us - time_us);
+        }
+        time_us = record.time_us;
+        SimulatedGpioRegisters::instance().setExternal(record.pin, record.level == GPIOLevel::HIGH);
+        if (record.event == GpioTraceEvent::INTERRUPT)
+        {
+            simulateInterrupt(record.pin);
+        }
+    }
+
+    bool GpioTraceReplayer::step()
+    {
+        GpioTraceRecord record;
+        if (!reader.next(record))
+        {
+            return false;
+        }
+        deliver(record);
+        return true;
+    }
+
+    size_t GpioTraceReplayer::run()
+    {
+        size_t delivered = 0;
+        while (step())
+        {
+            delivered++;
+        }
+        return delivered;
+    }
+
+    size_t GpioTraceReplayer::deliverInterrupts()
+    {
+        size_t delivered = 0;
+        GpioTraceRecord record;
+        while (reader.peek(record) && record.event == GpioTraceEvent::INTERRUPT)
+        {
+            step();
+            delivered++;
+        }
+        return delivered;
+    }
+
+    size_t GpioTraceReplayer::runUntil(uint64_t end_us)
+    {
+        size_t delivered = 0;
+        GpioTraceRecord record;
+        while (reader.peek(record) && record.time_us <= end_us)
+        {
+            step();
+            delivered++;
+        }
+        return delivered;
+    }
+
+    bool GpioTraceReplayer::serveRead(uint32_t pin, GPIOLevel &level) noexcept
+    {
+        GpioTraceReplayer *replayer = attached_replayer;
+        if (!replayer)
+        {
+            return false;
+        }
+
+        // pending interrupts are left to deliverInterrupts(), handlers and timers may throw
+        GpioTraceRecord record;
+        if (!replayer->reader.peek(record))
+        {
+            return false;
+        }
+        if (record.event != GpioTraceEvent::READ || record.pin != pin)
+        {
+            replayer->mismatch_count++;
+            return false;
+        }
+
+        replayer->reader.next(record);
+        if (GpioClock::isVirtual() && record.time_us > replayer->time_us)
+        {
+            GpioClock::skipNs((record.time_us - replayer->time_us) * 1000);
+        }
+        replayer->time_us = record.time_us;
+        SimulatedGpioRegisters::instance().setExternal(record.pin, record.level == GPIOLevel::HIGH);
+        level = record.level;
+        return true;
+    }
+#endif
+
+}
+
+#endif
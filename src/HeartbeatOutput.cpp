@@ -0,0 +1,165 @@
+#if __cpp_exceptions
+
+#include "esp_attr.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "driver/gptimer.h"
+#endif
+#include "HeartbeatOutput.hpp"
+#include "GpioBanks.hpp"
+#include "GpioClock.hpp"
+
+namespace Components
+{
+
+#define GPIO_CHECK_THROW(err) CHECK_THROW_SPECIFIC((err), GPIOException)
+
+    namespace
+    {
+        constexpr uint32_t TIMER_RESOLUTION_HZ = 1000000;
+
+#if !CONFIG_IDF_TARGET_LINUX
+        bool IRAM_ATTR timerAlarm(gptimer_handle_t, const gptimer_alarm_event_data_t *, void *arg)
+        {
+            static_cast<HeartbeatOutput *>(arg)->tick();
+            return false;
+        }
+#else
+        void virtualTick(void *arg)
+        {
+            static_cast<HeartbeatOutput *>(arg)->tick();
+        }
+#endif
+    }
+
+    HeartbeatOutput::HeartbeatOutput(PinOutput &pin, uint32_t half_period_us)
+        : pin_mask{pin.getNum()},
+          half_period_us(half_period_us),
+          level(false),
+          check_count(0),
+          timeouts_us{},
+          missed_toggles(0),
+          timer(nullptr)
+    {
+        pin.setLow();
+
+#if !CONFIG_IDF_TARGET_LINUX
+        gptimer_config_t config = {};
+        config.clk_src = GPTIMER_CLK_SRC_DEFAULT;
+        config.direction = GPTIMER_COUNT_UP;
+        config.resolution_hz = TIMER_RESOLUTION_HZ;
+        GPIO_CHECK_THROW(gptimer_new_timer(&config, &timer));
+
+        try
+        {
+            gptimer_event_callbacks_t callbacks = {};
+            callbacks.on_alarm = timerAlarm;
+            GPIO_CHECK_THROW(gptimer_register_event_callbacks(timer, &callbacks, this));
+
+            gptimer_alarm_config_t alarm = {};
+            alarm.alarm_count = static_cast<uint64_t>(half_period_us) * TIMER_RESOLUTION_HZ / 1000000;
+            alarm.reload_count = 0;
+            alarm.flags.auto_reload_on_alarm = true;
+            GPIO_CHECK_THROW(gptimer_set_alarm_action(timer, &alarm));
+            GPIO_CHECK_THROW(gptimer_enable(timer));
+        }
+        catch (const GPIOException &)
+        {
+            // the destructor doesn't run for a throwing constructor, the timer isn't enabled yet
+            gptimer_del_timer(timer);
+            timer = nullptr;
+            throw;
+        }
+#endif
+    }
+
+    HeartbeatOutput::~HeartbeatOutput()
+    {
+#if !CONFIG_IDF_TARGET_LINUX
+        if (timer)
+        {
+            gptimer_stop(timer);
+            gptimer_disable(timer);
+            gptimer_del_timer(timer);
+        }
+#else
+        GpioClock::stopTimer(virtual_timer);
+#endif
+    }
+
+    size_t HeartbeatOutput::addCheck(uint32_t timeout_us)
+    {
+        if (check_count == MAX_CHECKS)
+        {
+            throw GPIOException(ESP_ERR_NO_MEM);
+        }
+
+        timeouts_us[check_count] = timeout_us;
+        deadlines_us[check_count].store(GpioClock::nowUs() + timeout_us, std::memory_order_relaxed);
+        return check_count++;
+    }
+
+    void IRAM_ATTR HeartbeatOutput::feed(size_t check) noexcept
+    {
+        if (check < check_count)
+        {
+            deadlines_us[check].store(GpioClock::nowUs() + timeouts_us[check], std::memory_order_relaxed);
+        }
+    }
+
+    bool IRAM_ATTR HeartbeatOutput::isHealthy() const noexcept
+    {
+        int64_t now = GpioClock::nowUs();
+        for (size_t i = 0; i < check_count; i++)
+        {
+            if (now > deadlines_us[i].load(std::memory_order_relaxed))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void HeartbeatOutput::start()
+    {
+#if !CONFIG_IDF_TARGET_LINUX
+        GPIO_CHECK_THROW(gptimer_start(timer));
+#else
+        if (virtual_timer < 0)
+        {
+            virtual_timer = GpioClock::startTimer(virtualTick, this, half_period_us);
+        }
+#endif
+    }
+
+    void HeartbeatOutput::stop()
+    {
+#if !CONFIG_IDF_TARGET_LINUX
+        GPIO_CHECK_THROW(gptimer_stop(timer));
+#else
+        GpioClock::stopTimer(virtual_timer);
+        virtual_timer = -1;
+#endif
+    }
+
+    void IRAM_ATTR HeartbeatOutput::tick() noexcept
+    {
+        if (!isHealthy())
+        {
+            missed_toggles.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        level = !level;
+        if (level)
+        {
+            GpioBanks::setHigh(pin_mask);
+        }
+        else
+        {
+            GpioBanks::setLow(pin_mask);
+        }
+    }
+
+}
+
+#endif
@@ -0,0 +1,606 @@
+#if __cpp_exceptions
+
+#include <cstdlib>
+#include "esp_attr.h"
+#include "InfraRed.hpp"
+#include "GpioClock.hpp"
+#if GPIO_IR_USE_RMT
+#include "driver/rmt_rx.h"
+#include "driver/rmt_tx.h"
+#endif
+
+namespace Components
+{
+
+#define GPIO_CHECK_THROW(err) CHECK_THROW_SPECIFIC((err), GPIOException)
+
+    namespace
+    {
+        enum class IREncoding : uint8_t
+        {
+            PULSE_DISTANCE, // bit value in the length of the space
+            PULSE_WIDTH,    // bit value in the length of the mark
+            MANCHESTER      // bit value in the direction of the mid bit transition
+        };
+
+        struct IRProtocolSpec
+        {
+            IRProtocol protocol;
+            IREncoding encoding;
+            uint32_t carrier_hz;
+            uint16_t header_mark;
+            uint16_t header_space;
+            uint16_t zero_mark;
+            uint16_t zero_space;
+            uint16_t one_mark;
+            uint16_t one_space;
+            uint16_t repeat_space;
+            uint8_t min_bits;
+            uint8_t max_bits;
+        };
+
+        /**
+         * Timings of all supported protocols. For MANCHESTER, \c zero_mark is the half bit time.
+         */
+        constexpr IRProtocolSpec PROTOCOLS[] = {
+            {IRProtocol::NEC, IREncoding::PULSE_DISTANCE, 38000, 9000, 4500, 560, 560, 560, 1690, 2250, 32, 32},
+            {IRProtocol::SONY, IREncoding::PULSE_WIDTH, 40000, 2400, 600, 600, 600, 1200, 600, 0, 12, 20},
+            {IRProtocol::RC5, IREncoding::MANCHESTER, 36000, 0, 0, 889, 889, 889, 889, 0, 14, 14},
+        };
+
+        constexpr uint32_t FRAME_GAP_US = 10000;
+
+        bool matches(uint32_t measured, uint32_t expected) noexcept
+        {
+            uint32_t tolerance = expected / 4 + 100;
+            return measured + tolerance >= expected && measured <= expected + tolerance;
+        }
+
+        /**
+         * A space of 0 or anything longer than a frame gap ends a frame, so the last bit may have no real space.
+         */
+        bool matchesSpace(uint32_t measured, uint32_t expected, bool last) noexcept
+        {
+            return matches(measured, expected) || (last && (measured == 0 || measured >= FRAME_GAP_US));
+        }
+
+        esp_err_t decodePulse(const IRProtocolSpec &spec, const IRSymbol *symbols, size_t count, IRCode &code) noexcept
+        {
+            if (count < 2 || !matches(symbols[0].mark_us, spec.header_mark))
+            {
+                return ESP_ERR_INVALID_RESPONSE;
+            }
+
+            if (spec.repeat_space && matches(symbols[0].space_us, spec.repeat_space))
+            {
+                code = IRCode{spec.protocol, 0, 0, true};
+                return ESP_OK;
+            }
+
+            if (!matches(symbols[0].space_us, spec.header_space))
+            {
+                return ESP_ERR_INVALID_RESPONSE;
+            }
+
+            // pulse distance codes end with a stop mark which carries no data
+            size_t bits = count - 1;
+            if (spec.encoding == IREncoding::PULSE_DISTANCE)
+            {
+                bits--;
+            }
+            if (bits < spec.min_bits || bits > spec.max_bits)
+            {
+                return ESP_ERR_INVALID_RESPONSE;
+            }
+
+            uint32_t data = 0;
+            for (size_t i = 0; i < bits; i++)
+            {
+                const IRSymbol &symbol = symbols[i + 1];
+                bool last = spec.encoding == IREncoding::PULSE_WIDTH && i == bits - 1;
+                if (matches(symbol.mark_us, spec.one_mark) && matchesSpace(symbol.space_us, spec.one_space, last))
+                {
+                    data |= 1u << i;
+                }
+                else if (!matches(symbol.mark_us, spec.zero_mark)
+                         || !matchesSpace(symbol.space_us, spec.zero_space, last))
+                {
+                    return ESP_ERR_INVALID_RESPONSE;
+                }
+            }
+
+            code = IRCode{spec.protocol, data, static_cast<uint8_t>(bits), false};
+            return ESP_OK;
+        }
+
+        esp_err_t decodeManchester(const IRProtocolSpec &spec, const IRSymbol *symbols, size_t count, IRCode &code) noexcept
+        {
+            const uint32_t half_bit = spec.zero_mark;
+            constexpr size_t MAX_HALVES = 2 * 32;
+            std::array<uint8_t, MAX_HALVES> halves;
+
+            // the first half of the leading start bit is a space which is indistinguishable from idle
+            size_t half_count = 0;
+            halves[half_count++] = 0;
+
+            auto add_halves = [&](uint8_t level, uint32_t duration) {
+                size_t repeat;
+                if (matches(duration, half_bit))
+                {
+                    repeat = 1;
+                }
+                else if (matches(duration, 2 * half_bit))
+                {
+                    repeat = 2;
+                }
+                else if (!level && (duration == 0 || duration >= FRAME_GAP_US))
+                {
+                    repeat = 0;
+                }
+                else
+                {
+                    return false;
+                }
+
+                if (half_count + repeat > MAX_HALVES)
+                {
+                    return false;
+                }
+                for (size_t r = 0; r < repeat; r++)
+                {
+                    halves[half_count++] = level;
+                }
+                return true;
+            };
+
+            for (size_t i = 0; i < count; i++)
+            {
+                if (!add_halves(1, symbols[i].mark_us) || !add_halves(0, symbols[i].space_us))
+                {
+                    return ESP_ERR_INVALID_RESPONSE;
+                }
+            }
+
+            // a trailing zero bit ends with a space which again merges into idle
+            if (half_count % 2)
+            {
+                halves[half_count++] = 0;
+            }
+
+            size_t bits = half_count / 2;
+            if (bits < spec.min_bits || bits > spec.max_bits)
+            {
+                return ESP_ERR_INVALID_RESPONSE;
+            }
+
+            uint32_t data = 0;
+            for (size_t i = 0; i < bits; i++)
+            {
+                uint8_t first = halves[2 * i];
+                uint8_t second = halves[2 * i + 1];
+                if (first == second)
+                {
+                    return ESP_ERR_INVALID_RESPONSE;
+                }
+                data = (data << 1) | second;
+            }
+
+            code = IRCode{spec.protocol, data, static_cast<uint8_t>(bits), false};
+            return ESP_OK;
+        }
+
+        /**
+         * Append a half bit of \c level to the frame, merging it with the previous symbol where possible.
+         */
+        bool appendManchesterHalf(IRFrame &frame, uint8_t level, uint16_t duration) noexcept
+        {
+            if (level)
+            {
+                if (frame.symbol_count > 0 && frame.symbols[frame.symbol_count - 1].space_us == 0)
+                {
+                    frame.symbols[frame.symbol_count - 1].mark_us += duration;
+                    return true;
+                }
+                if (frame.symbol_count == IRFrame::MAX_SYMBOLS)
+                {
+                    return false;
+                }
+                frame.symbols[frame.symbol_count++] = IRSymbol{duration, 0};
+                return true;
+            }
+
+            // leading spaces are idle time
+            if (frame.symbol_count > 0)
+            {
+                frame.symbols[frame.symbol_count - 1].space_us += duration;
+            }
+            return true;
+        }
+
+        esp_err_t encodeWith(const IRProtocolSpec &spec, const IRCode &code, IRFrame &frame) noexcept
+        {
+            frame.carrier_hz = spec.carrier_hz;
+            frame.symbol_count = 0;
+
+            if (code.repeat)
+            {
+                if (!spec.repeat_space)
+                {
+                    return ESP_ERR_NOT_SUPPORTED;
+                }
+                frame.symbols[frame.symbol_count++] = IRSymbol{spec.header_mark, spec.repeat_space};
+                frame.symbols[frame.symbol_count++] = IRSymbol{spec.zero_mark, 0};
+                return ESP_OK;
+            }
+
+            if (code.bits < spec.min_bits || code.bits > spec.max_bits)
+            {
+                return ESP_ERR_INVALID_SIZE;
+            }
+
+            if (spec.encoding == IREncoding::MANCHESTER)
+            {
+                for (int i = code.bits - 1; i >= 0; i--)
+                {
+                    uint8_t bit = (code.data >> i) & 1;
+                    if (!appendManchesterHalf(frame, !bit, spec.zero_mark) || !appendManchesterHalf(frame, bit, spec.zero_mark))
+                    {
+                        return ESP_ERR_INVALID_SIZE;
+                    }
+                }
+                frame.symbols[frame.symbol_count - 1].space_us = 0;
+                return ESP_OK;
+            }
+
+            frame.symbols[frame.symbol_count++] = IRSymbol{spec.header_mark, spec.header_space};
+            for (size_t i = 0; i < code.bits; i++)
+            {
+                bool one = (code.data >> i) & 1;
+                frame.symbols[frame.symbol_count++] = one ? IRSymbol{spec.one_mark, spec.one_space}
+                                                          : IRSymbol{spec.zero_mark, spec.zero_space};
+            }
+
+            if (spec.encoding == IREncoding::PULSE_DISTANCE)
+            {
+                frame.symbols[frame.symbol_count++] = IRSymbol{spec.zero_mark, 0};
+            }
+            else
+            {
+                frame.symbols[frame.symbol_count - 1].space_us = 0;
+            }
+            return ESP_OK;
+        }
+    }
+
+    uint16_t IRCode::getAddress() const noexcept
+    {
+        switch (protocol)
+        {
+        case IRProtocol::NEC:
+            // extended NEC uses the inverted address byte as high byte of a 16 bit address
+            if (((data >> 8) & 0xff) == (~data & 0xff))
+            {
+                return data & 0xff;
+            }
+            return data & 0xffff;
+        case IRProtocol::SONY:
+            return static_cast<uint16_t>(data >> 7);
+        case IRProtocol::RC5:
+            return (data >> 6) & 0x1f;
+        }
+        return 0;
+    }
+
+    uint16_t IRCode::getCommand() const noexcept
+    {
+        switch (protocol)
+        {
+        case IRProtocol::NEC:
+            return (data >> 16) & 0xff;
+        case IRProtocol::SONY:
+            return data & 0x7f;
+        case IRProtocol::RC5:
+            return data & 0x3f;
+        }
+        return 0;
+    }
+
+    namespace IRCodec
+    {
+        esp_err_t decode(const IRSymbol *symbols, size_t count, IRCode &code) noexcept
+        {
+            for (const auto &spec : PROTOCOLS)
+            {
+                esp_err_t result;
+                if (spec.encoding == IREncoding::MANCHESTER)
+                {
+                    result = decodeManchester(spec, symbols, count, code);
+                }
+                else
+                {
+                    result = decodePulse(spec, symbols, count, code);
+                }
+
+                if (result == ESP_OK)
+                {
+                    return ESP_OK;
+                }
+            }
+            return ESP_ERR_INVALID_RESPONSE;
+        }
+
+        esp_err_t encode(const IRCode &code, IRFrame &frame) noexcept
+        {
+            for (const auto &spec : PROTOCOLS)
+            {
+                if (spec.protocol == code.protocol)
+                {
+                    return encodeWith(spec, code, frame);
+                }
+            }
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+    }
+
+#if GPIO_IR_USE_RMT
+
+    namespace
+    {
+        constexpr uint32_t RMT_RESOLUTION_HZ = 1000000;
+        constexpr size_t RMT_MEM_BLOCK_SYMBOLS = 64;
+        constexpr uint32_t RMT_MIN_PULSE_NS = 1250;
+        constexpr uint32_t RMT_TX_TIMEOUT_MS = 200;
+
+        static_assert(sizeof(rmt_symbol_word_t) == sizeof(uint32_t), "unexpected RMT symbol layout");
+
+        bool IRAM_ATTR rmtReceiveDone(rmt_channel_handle_t, const rmt_rx_done_event_data_t *event, void *arg)
+        {
+            static_cast<std::atomic<size_t> *>(arg)->store(event->num_symbols, std::memory_order_release);
+            return false;
+        }
+    }
+
+    IRReceiver::IRReceiver(GPIONum num) : frame_count(0), channel(nullptr), received_count(0), reception_error(ESP_OK)
+    {
+        rmt_rx_channel_config_t config = {};
+        config.gpio_num = num.get_value<gpio_num_t>();
+        config.clk_src = RMT_CLK_SRC_DEFAULT;
+        config.resolution_hz = RMT_RESOLUTION_HZ;
+        config.mem_block_symbols = RMT_MEM_BLOCK_SYMBOLS;
+        GPIO_CHECK_THROW(rmt_new_rx_channel(&config, &channel));
+
+        try
+        {
+            rmt_rx_event_callbacks_t callbacks = {};
+            callbacks.on_recv_done = rmtReceiveDone;
+            GPIO_CHECK_THROW(rmt_rx_register_event_callbacks(channel, &callbacks, &received_count));
+            GPIO_CHECK_THROW(rmt_enable(channel));
+        }
+        catch (const GPIOException &)
+        {
+            // the destructor doesn't run for a throwing constructor, the channel isn't enabled yet
+            rmt_del_channel(channel);
+            throw;
+        }
+
+        reception_error = restartReception();
+        if (reception_error != ESP_OK)
+        {
+            rmt_disable(channel);
+            rmt_del_channel(channel);
+            throw GPIOException(reception_error);
+        }
+    }
+
+    IRReceiver::~IRReceiver()
+    {
+        rmt_disable(channel);
+        rmt_del_channel(channel);
+    }
+
+    esp_err_t IRReceiver::restartReception() noexcept
+    {
+        rmt_receive_config_t config = {};
+        config.signal_range_min_ns = RMT_MIN_PULSE_NS;
+        config.signal_range_max_ns = FRAME_GAP_US * 1000;
+        received_count.store(0, std::memory_order_relaxed);
+        return rmt_receive(channel, raw.data(), raw.size() * sizeof(rmt_symbol_word_t), &config);
+    }
+
+    esp_err_t IRReceiver::poll(IRCode &code) noexcept
+    {
+        if (reception_error != ESP_OK)
+        {
+            reception_error = restartReception();
+            if (reception_error != ESP_OK)
+            {
+                return reception_error;
+            }
+        }
+
+        size_t count = received_count.load(std::memory_order_acquire);
+        if (count == 0)
+        {
+            return ESP_ERR_NOT_FOUND;
+        }
+
+        // the receiver output is active low, so level 0 is a mark
+        frame_count = 0;
+        for (size_t i = 0; i < count && i < MAX_SYMBOLS; i++)
+        {
+            rmt_symbol_word_t symbol;
+            symbol.val = raw[i];
+            frame[frame_count++] = IRSymbol{static_cast<uint16_t>(symbol.duration0), static_cast<uint16_t>(symbol.duration1)};
+        }
+        // the frame is copied already, a failed restart is reported by the next poll()
+        reception_error = restartReception();
+
+        return IRCodec::decode(frame.data(), frame_count, code);
+    }
+
+    IRTransmitter::IRTransmitter(GPIONum num) : channel(nullptr), encoder(nullptr), carrier_hz(0)
+    {
+        rmt_tx_channel_config_t config = {};
+        config.gpio_num = num.get_value<gpio_num_t>();
+        config.clk_src = RMT_CLK_SRC_DEFAULT;
+        config.resolution_hz = RMT_RESOLUTION_HZ;
+        config.mem_block_symbols = RMT_MEM_BLOCK_SYMBOLS;
+        config.trans_queue_depth = 4;
+        GPIO_CHECK_THROW(rmt_new_tx_channel(&config, &channel));
+
+        try
+        {
+            rmt_copy_encoder_config_t encoder_config = {};
+            GPIO_CHECK_THROW(rmt_new_copy_encoder(&encoder_config, &encoder));
+            GPIO_CHECK_THROW(rmt_enable(channel));
+        }
+        catch (const GPIOException &)
+        {
+            // the destructor doesn't run for a throwing constructor, the channel isn't enabled yet
+            if (encoder)
+            {
+                rmt_del_encoder(encoder);
+            }
+            rmt_del_channel(channel);
+            throw;
+        }
+    }
+
+    IRTransmitter::~IRTransmitter()
+    {
+        rmt_disable(channel);
+        rmt_del_encoder(encoder);
+        rmt_del_channel(channel);
+    }
+
+    void IRTransmitter::send(const IRFrame &ir_frame)
+    {
+        if (ir_frame.carrier_hz != carrier_hz)
+        {
+            rmt_carrier_config_t carrier = {};
+            carrier.frequency_hz = ir_frame.carrier_hz;
+            carrier.duty_cycle = 0.33f;
+            GPIO_CHECK_THROW(rmt_apply_carrier(channel, &carrier));
+            carrier_hz = ir_frame.carrier_hz;
+        }
+
+        std::array<rmt_symbol_word_t, IRFrame::MAX_SYMBOLS> symbols;
+        for (size_t i = 0; i < ir_frame.symbol_count; i++)
+        {
+            symbols[i].val = 0;
+            symbols[i].duration0 = ir_frame.symbols[i].mark_us;
+            symbols[i].level0 = 1;
+            symbols[i].duration1 = ir_frame.symbols[i].space_us;
+            symbols[i].level1 = 0;
+        }
+
+        rmt_transmit_config_t config = {};
+        GPIO_CHECK_THROW(rmt_transmit(channel, encoder, symbols.data(),
+                                      ir_frame.symbol_count * sizeof(rmt_symbol_word_t), &config));
+        GPIO_CHECK_THROW(rmt_tx_wait_all_done(channel, RMT_TX_TIMEOUT_MS));
+    }
+
+#else
+
+    IRReceiver::IRReceiver(GPIONum num)
+        : frame_count(0), pin(num), completed_count(0), has_last_edge(false), last_level(GPIOLevel::HIGH),
+          last_time_us(0)
+    {
+        capture.start(pin);
+    }
+
+    IRReceiver::~IRReceiver()
+    {
+        try
+        {
+            capture.stop();
+        }
+        catch (const GPIOException &)
+        {
+        }
+    }
+
+    void IRReceiver::collectEdges() noexcept
+    {
+        std::array<GPIOEdge, 16> batch;
+        size_t count;
+        while ((count = capture.read(batch.data(), batch.size())) > 0)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                uint32_t duration = batch[i].time_us - last_time_us;
+                if (has_last_edge && duration >= FRAME_GAP_US)
+                {
+                    // a long space ends the frame, keep it for poll() before the next one starts
+                    if (last_level == GPIOLevel::HIGH && frame_count > 0)
+                    {
+                        frame[frame_count - 1].space_us = 0;
+                        completed = frame;
+                        completed_count = frame_count;
+                    }
+                    frame_count = 0;
+                }
+                else if (has_last_edge && last_level == GPIOLevel::LOW && frame_count < MAX_SYMBOLS)
+                {
+                    // the receiver output is active low, so a low level is a mark
+                    frame[frame_count++] = IRSymbol{static_cast<uint16_t>(duration), 0};
+                }
+                else if (has_last_edge && frame_count > 0)
+                {
+                    frame[frame_count - 1].space_us = static_cast<uint16_t>(duration);
+                }
+
+                last_time_us = batch[i].time_us;
+                last_level = batch[i].level;
+                has_last_edge = true;
+            }
+        }
+    }
+
+    esp_err_t IRReceiver::poll(IRCode &code) noexcept
+    {
+        collectEdges();
+
+        if (completed_count > 0)
+        {
+            size_t count = completed_count;
+            completed_count = 0;
+            return IRCodec::decode(completed.data(), count, code);
+        }
+
+        uint32_t idle_us = static_cast<uint32_t>(GpioClock::nowUs()) - last_time_us;
+        if (frame_count == 0 || last_level != GPIOLevel::HIGH || idle_us < FRAME_GAP_US)
+        {
+            return ESP_ERR_NOT_FOUND;
+        }
+
+        frame[frame_count - 1].space_us = 0;
+        size_t count = frame_count;
+        frame_count = 0;
+        return IRCodec::decode(frame.data(), count, code);
+    }
+
+    IRTransmitter::IRTransmitter(GPIONum)
+    {
+        throw GPIOException(ESP_ERR_NOT_SUPPORTED);
+    }
+
+    IRTransmitter::~IRTransmitter() {}
+
+    void IRTransmitter::send(const IRFrame &)
+    {
+        throw GPIOException(ESP_ERR_NOT_SUPPORTED);
+    }
+
+#endif
+
+    void IRTransmitter::send(const IRCode &code)
+    {
+        IRFrame ir_frame;
+        GPIO_CHECK_THROW(IRCodec::encode(code, ir_frame));
+        send(ir_frame);
+    }
+
+}
+
+#endif
@@ -0,0 +1,202 @@
+#if __cpp_exceptions
+
+#include <array>
+#include <sys/time.h>
+#include "esp_attr.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_sleep.h"
+#include "soc/soc_caps.h"
+#endif
+#include "PinEventCounters.hpp"
+
+namespace Components
+{
+
+    namespace
+    {
+        struct UlpCounter
+        {
+            const volatile uint32_t *counter;
+            uint32_t mask;
+            uint32_t last_value;
+        };
+
+        struct CounterState
+        {
+            size_t tracked;
+            std::array<PinEventRecord, PinEventCounters::MAX_PINS> records;
+            std::array<UlpCounter, PinEventCounters::MAX_PINS> ulp;
+        };
+
+        // initialized on power up, retained in deep sleep
+        RTC_DATA_ATTR CounterState state;
+
+        int64_t wallClockUs() noexcept
+        {
+            struct timeval now;
+            gettimeofday(&now, nullptr);
+            return static_cast<int64_t>(now.tv_sec) * 1000000 + now.tv_usec;
+        }
+
+        PinEventRecord *find(uint32_t pin) noexcept
+        {
+            for (size_t i = 0; i < state.tracked; i++)
+            {
+                if (state.records[i].pin == pin)
+                {
+                    return &state.records[i];
+                }
+            }
+            return nullptr;
+        }
+
+        void count(PinEventRecord &record, uint32_t events, int64_t now_us) noexcept
+        {
+            record.count += events;
+            record.unreported += events;
+            record.last_event_us = now_us;
+        }
+    }
+
+    void PinEventCounters::track(GPIONum num)
+    {
+        uint32_t pin = num.get_value<uint32_t>();
+        if (find(pin))
+        {
+            return;
+        }
+
+        if (state.tracked == MAX_PINS)
+        {
+            throw GPIOException(ESP_ERR_NO_MEM);
+        }
+
+        state.records[state.tracked] = PinEventRecord{pin, 0, 0, 0};
+        state.ulp[state.tracked] = UlpCounter{nullptr, 0, 0};
+        state.tracked++;
+    }
+
+    void PinEventCounters::attachUlpCounter(GPIONum num, const volatile uint32_t *counter, uint32_t mask)
+    {
+        PinEventRecord *record = find(num.get_value<uint32_t>());
+        if (!record)
+        {
+            throw GPIOException(ESP_ERR_NOT_FOUND);
+        }
+
+        // attaching again after a wakeup keeps the baseline, so the edges counted during deep sleep are merged
+        UlpCounter &ulp = state.ulp[record - state.records.data()];
+        if (ulp.counter != counter || ulp.mask != mask)
+        {
+            ulp = UlpCounter{counter, mask, *counter & mask};
+        }
+    }
+
+    void PinEventCounters::mergeUlpCounters(int64_t now_us) noexcept
+    {
+        for (size_t i = 0; i < state.tracked; i++)
+        {
+            UlpCounter &ulp = state.ulp[i];
+            if (!ulp.counter)
+            {
+                continue;
+            }
+
+            uint32_t value = *ulp.counter & ulp.mask;
+            uint32_t events = (value - ulp.last_value) & ulp.mask;
+            ulp.last_value = value;
+            if (events)
+            {
+                count(state.records[i], events, now_us);
+            }
+        }
+    }
+
+    void PinEventCounters::recordWakeup() noexcept
+    {
+        int64_t now_us = wallClockUs();
+        mergeUlpCounters(now_us);
+
+#if !CONFIG_IDF_TARGET_LINUX
+        uint64_t wakeup_pins = 0;
+        switch (esp_sleep_get_wakeup_cause())
+        {
+#if SOC_PM_SUPPORT_EXT1_WAKEUP || SOC_PM_SUPPORT_EXT_WAKEUP
+        case ESP_SLEEP_WAKEUP_EXT1:
+            wakeup_pins = esp_sleep_get_ext1_wakeup_status();
+            break;
+#endif
+#if SOC_GPIO_SUPPORT_DEEPSLEEP_WAKEUP
+        case ESP_SLEEP_WAKEUP_GPIO:
+            wakeup_pins = esp_sleep_get_gpio_wakeup_status();
+            break;
+#endif
+        default:
+            break;
+        }
+
+        GpioMask pins = GpioMask::fromBits(wakeup_pins);
+        for (uint32_t pin : pins)
+        {
+            PinEventRecord *record = find(pin);
+            if (record)
+            {
+                count(*record, 1, now_us);
+            }
+        }
+#endif
+    }
+
+    void PinEventCounters::recordEvents(const GpioMask &pins) noexcept
+    {
+        int64_t now_us = wallClockUs();
+        for (size_t i = 0; i < state.tracked; i++)
+        {
+            if (pins.contains(state.records[i].pin))
+            {
+                count(state.records[i], 1, now_us);
+            }
+        }
+    }
+
+    size_t PinEventCounters::read(PinEventRecord *records, size_t max_records) noexcept
+    {
+        size_t copied = state.tracked < max_records ? state.tracked : max_records;
+        for (size_t i = 0; i < copied; i++)
+        {
+            records[i] = state.records[i];
+        }
+        return copied;
+    }
+
+    uint32_t PinEventCounters::pendingEvents() noexcept
+    {
+        uint32_t pending = 0;
+        for (size_t i = 0; i < state.tracked; i++)
+        {
+            pending += state.records[i].unreported;
+        }
+        return pending;
+    }
+
+    void PinEventCounters::markReported() noexcept
+    {
+        for (size_t i = 0; i < state.tracked; i++)
+        {
+            state.records[i].unreported = 0;
+        }
+    }
+
+    void PinEventCounters::clear() noexcept
+    {
+        for (size_t i = 0; i < state.tracked; i++)
+        {
+            state.records[i].count = 0;
+            state.records[i].unreported = 0;
+            state.records[i].last_event_us = 0;
+        }
+    }
+
+}
+
+#endif
@@ -0,0 +1,116 @@
+#if __cpp_exceptions
+
+#include "driver/gpio.h"
+#include "PinSet.hpp"
+
+namespace Components
+{
+
+#define GPIO_CHECK_THROW(err) CHECK_THROW_SPECIFIC((err), GPIOException)
+
+    namespace
+    {
+        gpio_mode_t toDriverMode(uint8_t mode) noexcept
+        {
+            switch (static_cast<PinSetMode>(mode))
+            {
+            case PinSetMode::INPUT:
+                return GPIO_MODE_INPUT;
+            case PinSetMode::OUTPUT:
+                return GPIO_MODE_OUTPUT;
+            case PinSetMode::OUTPUT_INPUT_OD:
+                return GPIO_MODE_INPUT_OUTPUT_OD;
+            default:
+                return GPIO_MODE_DISABLE;
+            }
+        }
+    }
+
+    PinSetBase::PinSetBase(PinHandle *handles, PinSetConfig *configs, size_t capacity) noexcept
+        : handles(handles), configs(configs), capacity(capacity), count(0) {}
+
+    size_t PinSetBase::add(PinHandle handle, PinSetMode mode, GPIOPullMode pull, GPIODriveStrength strength)
+    {
+        if (count == capacity)
+        {
+            throw GPIOException(ESP_ERR_NO_MEM);
+        }
+
+        PinSetConfig config = {};
+        config.mode = static_cast<uint8_t>(mode);
+        config.pull = pull.get_value<uint8_t>();
+        config.drive = strength.get_value<uint8_t>();
+        config.level = mode == PinSetMode::OUTPUT_INPUT_OD ? 1 : 0;
+
+        handles[count] = handle;
+        configs[count] = config;
+        return count++;
+    }
+
+    void PinSetBase::apply()
+    {
+        // one gpio_config() call per distinct (mode, pull) combination, 16 at most
+        constexpr size_t GROUPS = 16;
+        std::array<uint64_t, GROUPS> group_masks = {};
+
+        for (size_t i = 0; i < count; i++)
+        {
+            if (!handles[i].isNative())
+            {
+                continue;
+            }
+
+            gpio_num_t num = static_cast<gpio_num_t>(handles[i].getIndex());
+            GPIO_CHECK_THROW(gpio_set_level(num, configs[i].level));
+            group_masks[(configs[i].mode << 2) | configs[i].pull] |= 1ULL << handles[i].getIndex();
+        }
+
+        for (size_t group = 0; group < GROUPS; group++)
+        {
+            if (!group_masks[group])
+            {
+                continue;
+            }
+
+            gpio_pull_mode_t pull = static_cast<gpio_pull_mode_t>(group & 3);
+            gpio_config_t config = {};
+            config.pin_bit_mask = group_masks[group];
+            config.mode = toDriverMode(static_cast<uint8_t>(group >> 2));
+            config.pull_up_en = (pull == GPIO_PULLUP_ONLY || pull == GPIO_PULLUP_PULLDOWN) ? GPIO_PULLUP_ENABLE : GPIO_PULLUP_DISABLE;
+            config.pull_down_en = (pull == GPIO_PULLDOWN_ONLY || pull == GPIO_PULLUP_PULLDOWN) ? GPIO_PULLDOWN_ENABLE : GPIO_PULLDOWN_DISABLE;
+            config.intr_type = GPIO_INTR_DISABLE;
+            GPIO_CHECK_THROW(gpio_config(&config));
+        }
+
+        for (size_t i = 0; i < count; i++)
+        {
+            if (handles[i].isNative() && configs[i].mode != static_cast<uint8_t>(PinSetMode::INPUT))
+            {
+                GPIO_CHECK_THROW(gpio_set_drive_capability(static_cast<gpio_num_t>(handles[i].getIndex()),
+                                                           static_cast<gpio_drive_cap_t>(configs[i].drive)));
+            }
+        }
+    }
+
+    void PinSetBase::setLevel(size_t index, GPIOLevel level)
+    {
+        configs[index].level = level == GPIOLevel::HIGH ? 1 : 0;
+        if (handles[index].isNative())
+        {
+            GPIO_CHECK_THROW(gpio_set_level(static_cast<gpio_num_t>(handles[index].getIndex()), configs[index].level));
+        }
+    }
+
+    GPIOLevel PinSetBase::getLevel(size_t index) const noexcept
+    {
+        int level = configs[index].level;
+        if (handles[index].isNative())
+        {
+            level = gpio_get_level(static_cast<gpio_num_t>(handles[index].getIndex()));
+        }
+        return level ? GPIOLevel::HIGH : GPIOLevel::LOW;
+    }
+
+}
+
+#endif
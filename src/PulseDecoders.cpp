@@ -0,0 +1,323 @@
+#if __cpp_exceptions
+
+#include <cstdint>
+#include "PulseDecoders.hpp"
+#include "GpioClock.hpp"
+
+namespace Components
+{
+
+    namespace
+    {
+        constexpr uint8_t ANY = PulseRule::ANY_LEVEL;
+
+        enum DHTState : uint8_t
+        {
+            DHT_START,
+            DHT_RESPONSE_HIGH,
+            DHT_BIT_LOW,
+            DHT_BIT_HIGH
+        };
+
+        constexpr PulseRule DHT_RULES[] = {
+            {DHT_START, 0, 500, 30000, DHT_START, PulseAction::NONE},          // host start signal
+            {DHT_START, 1, 5, 60, DHT_START, PulseAction::NONE},               // bus released by host
+            {DHT_START, 0, 60, 100, DHT_RESPONSE_HIGH, PulseAction::NONE},     // sensor response, low part
+            {DHT_RESPONSE_HIGH, 1, 60, 100, DHT_BIT_LOW, PulseAction::NONE},   // sensor response, high part
+            {DHT_BIT_LOW, 0, 30, 80, DHT_BIT_HIGH, PulseAction::NONE},         // start of every bit
+            {DHT_BIT_HIGH, 1, 10, 45, DHT_BIT_LOW, PulseAction::BIT_0},        // 26us - 28us high
+            {DHT_BIT_HIGH, 1, 50, 95, DHT_BIT_LOW, PulseAction::BIT_1},        // 70us high
+        };
+
+        constexpr PulseRule ULTRASONIC_RULES[] = {
+            {0, 1, 100, 38000, 0, PulseAction::VALUE}, // echo pulse, longer pulses mean "nothing in range"
+            {0, 0, 0, UINT32_MAX, 0, PulseAction::NONE},
+        };
+
+        constexpr PulseRule RC_PWM_RULES[] = {
+            {0, 1, 800, 2200, 0, PulseAction::VALUE},
+            {0, 0, 0, UINT32_MAX, 0, PulseAction::NONE},
+        };
+
+        enum PPMState : uint8_t
+        {
+            PPM_WAIT_SYNC,
+            PPM_FRAME
+        };
+
+        constexpr PulseRule RC_PPM_RULES[] = {
+            {PPM_WAIT_SYNC, ANY, 2700, UINT32_MAX, PPM_FRAME, PulseAction::SYNC},
+            {PPM_FRAME, ANY, 700, 2300, PPM_FRAME, PulseAction::VALUE},
+            {PPM_FRAME, ANY, 2700, UINT32_MAX, PPM_FRAME, PulseAction::SYNC},
+        };
+
+        constexpr uint32_t DHT11_START_US = 20000;
+        constexpr uint32_t DHT22_START_US = 1100;
+        constexpr uint32_t ULTRASONIC_TRIGGER_US = 10;
+
+        void stopQuietly(EdgeCaptureBase &capture) noexcept
+        {
+            try
+            {
+                capture.stop();
+            }
+            catch (const GPIOException &)
+            {
+            }
+        }
+    }
+
+    PulseStateMachine::PulseStateMachine(const PulseRule *rules, size_t rule_count) noexcept
+        : rules(rules), rule_count(rule_count), state(0) {}
+
+    const PulseRule *PulseStateMachine::step(uint8_t level, uint32_t duration_us) noexcept
+    {
+        for (size_t i = 0; i < rule_count; i++)
+        {
+            const PulseRule &rule = rules[i];
+            if (rule.state == state
+                && (rule.level == PulseRule::ANY_LEVEL || rule.level == level)
+                && duration_us >= rule.min_us
+                && duration_us <= rule.max_us)
+            {
+                state = rule.next_state;
+                return &rule;
+            }
+        }
+
+        state = 0;
+        return nullptr;
+    }
+
+    void PulseStateMachine::reset() noexcept
+    {
+        state = 0;
+    }
+
+    PulseExtractor::PulseExtractor() noexcept : has_last_edge(false), last_level(0), last_time_us(0) {}
+
+    void PulseExtractor::reset() noexcept
+    {
+        has_last_edge = false;
+    }
+
+    DHTSensor::DHTSensor(PinOutputInput &pin, Type type) : pin(pin), type(type)
+    {
+        pin.setFloating();
+        capture.start(pin);
+    }
+
+    DHTSensor::~DHTSensor()
+    {
+        stopQuietly(capture);
+    }
+
+    void DHTSensor::startReading()
+    {
+        capture.clear();
+        pin.setLow();
+        GpioClock::delayUs(type == Type::DHT11 ? DHT11_START_US : DHT22_START_US);
+        pin.setFloating();
+    }
+
+    esp_err_t DHTSensor::read(DHTReading &reading) noexcept
+    {
+        PulseExtractor extractor;
+        PulseStateMachine machine(DHT_RULES, std::size(DHT_RULES));
+        std::array<uint8_t, DATA_BITS / 8> data = {};
+        size_t bits = 0;
+
+        extractor.drain(capture, [&](uint8_t level, uint32_t duration_us) {
+            if (bits >= DATA_BITS)
+            {
+                return;
+            }
+
+            const PulseRule *rule = machine.step(level, duration_us);
+            if (!rule)
+            {
+                bits = 0;
+                data.fill(0);
+                return;
+            }
+
+            if (rule->action == PulseAction::BIT_0 || rule->action == PulseAction::BIT_1)
+            {
+                data[bits / 8] = static_cast<uint8_t>(data[bits / 8] << 1) | (rule->action == PulseAction::BIT_1);
+                bits++;
+            }
+        });
+
+        if (bits < DATA_BITS)
+        {
+            return ESP_ERR_TIMEOUT;
+        }
+
+        if (static_cast<uint8_t>(data[0] + data[1] + data[2] + data[3]) != data[4])
+        {
+            return ESP_ERR_INVALID_CRC;
+        }
+
+        if (type == Type::DHT11)
+        {
+            reading.humidity = static_cast<int16_t>(data[0] * 10 + data[1]);
+            reading.temperature = static_cast<int16_t>(data[2] * 10 + (data[3] & 0x7f));
+            if (data[3] & 0x80)
+            {
+                reading.temperature = static_cast<int16_t>(-reading.temperature);
+            }
+        }
+        else
+        {
+            reading.humidity = static_cast<int16_t>((data[0] << 8) | data[1]);
+            reading.temperature = static_cast<int16_t>(((data[2] & 0x7f) << 8) | data[3]);
+            if (data[2] & 0x80)
+            {
+                reading.temperature = static_cast<int16_t>(-reading.temperature);
+            }
+        }
+
+        return ESP_OK;
+    }
+
+    UltrasonicSensor::UltrasonicSensor(PinOutput &trigger, PinInput &echo) : trigger(trigger), echo(echo)
+    {
+        trigger.setLow();
+        capture.start(echo);
+    }
+
+    UltrasonicSensor::~UltrasonicSensor()
+    {
+        stopQuietly(capture);
+    }
+
+    void UltrasonicSensor::startMeasurement()
+    {
+        capture.clear();
+        trigger.setHigh();
+        GpioClock::delayUs(ULTRASONIC_TRIGGER_US);
+        trigger.setLow();
+    }
+
+    esp_err_t UltrasonicSensor::readDistance(uint32_t &distance_mm) noexcept
+    {
+        PulseExtractor extractor;
+        PulseStateMachine machine(ULTRASONIC_RULES, std::size(ULTRASONIC_RULES));
+        uint32_t echo_us = 0;
+
+        extractor.drain(capture, [&](uint8_t level, uint32_t duration_us) {
+            const PulseRule *rule = machine.step(level, duration_us);
+            if (rule && rule->action == PulseAction::VALUE && echo_us == 0)
+            {
+                echo_us = duration_us;
+            }
+        });
+
+        if (echo_us == 0)
+        {
+            return ESP_ERR_TIMEOUT;
+        }
+
+        // sound travels 0.343mm per microsecond, the echo covers the distance twice
+        distance_mm = echo_us * 343 / 2000;
+        return ESP_OK;
+    }
+
+    RCPWMDecoder::RCPWMDecoder(PinInput &pin)
+        : machine(RC_PWM_RULES, std::size(RC_PWM_RULES)), pulse_width_us(0)
+    {
+        capture.start(pin);
+    }
+
+    RCPWMDecoder::~RCPWMDecoder()
+    {
+        stopQuietly(capture);
+    }
+
+    size_t RCPWMDecoder::process() noexcept
+    {
+        size_t decoded = 0;
+        extractor.drain(capture, [&](uint8_t level, uint32_t duration_us) {
+            const PulseRule *rule = machine.step(level, duration_us);
+            if (rule && rule->action == PulseAction::VALUE)
+            {
+                pulse_width_us = duration_us;
+                decoded++;
+            }
+        });
+        return decoded;
+    }
+
+    RCPPMDecoder::RCPPMDecoder(PinInput &pin)
+        : machine(RC_PPM_RULES, std::size(RC_PPM_RULES)),
+          has_rising_edge(false),
+          last_rising_us(0),
+          channel_index(0),
+          channel_count(0),
+          pending{},
+          channels{}
+    {
+        capture.start(pin, GPIOIntrType::POSEDGE());
+    }
+
+    RCPPMDecoder::~RCPPMDecoder()
+    {
+        stopQuietly(capture);
+    }
+
+    size_t RCPPMDecoder::process() noexcept
+    {
+        std::array<GPIOEdge, 16> batch;
+        size_t frames = 0;
+        size_t count;
+
+        while ((count = capture.read(batch.data(), batch.size())) > 0)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                uint32_t period_us = batch[i].time_us - last_rising_us;
+                bool had_rising_edge = has_rising_edge;
+                last_rising_us = batch[i].time_us;
+                has_rising_edge = true;
+                if (!had_rising_edge)
+                {
+                    continue;
+                }
+
+                const PulseRule *rule = machine.step(ANY, period_us);
+                if (!rule)
+                {
+                    channel_index = 0;
+                }
+                else if (rule->action == PulseAction::SYNC)
+                {
+                    if (channel_index > 0)
+                    {
+                        channels = pending;
+                        channel_count = channel_index;
+                        frames++;
+                    }
+                    channel_index = 0;
+                }
+                else if (rule->action == PulseAction::VALUE && channel_index < MAX_CHANNELS)
+                {
+                    pending[channel_index++] = static_cast<uint16_t>(period_us);
+                }
+            }
+        }
+
+        return frames;
+    }
+
+    uint32_t RCPPMDecoder::getChannel(size_t channel) const noexcept
+    {
+        if (channel >= channel_count)
+        {
+            return 0;
+        }
+        return channels[channel];
+    }
+
+}
+
+#endif
@@ -0,0 +1,89 @@
+#if __cpp_exceptions
+
+#include "esp_attr.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_system.h"
+#endif
+#include "SafeState.hpp"
+#include "GpioBanks.hpp"
+#include "GpioClock.hpp"
+
+namespace Components
+{
+
+#define GPIO_CHECK_THROW(err) CHECK_THROW_SPECIFIC((err), GPIOException)
+
+    namespace
+    {
+        DRAM_ATTR GpioMask safe_high;
+        DRAM_ATTR GpioMask safe_low;
+
+        void shutdownHandler()
+        {
+            SafeState::apply();
+        }
+    }
+
+    void SafeState::registerOutput(const PinOutput &pin, GPIOLevel safe_level) noexcept
+    {
+        uint32_t num = pin.getNum().get_value<uint32_t>();
+        if (safe_level == GPIOLevel::HIGH)
+        {
+            safe_low.reset(num);
+            safe_high.set(num);
+        }
+        else
+        {
+            safe_high.reset(num);
+            safe_low.set(num);
+        }
+    }
+
+    void SafeState::registerOutput(const PinOutputInput &pin) noexcept
+    {
+        uint32_t num = pin.getNum().get_value<uint32_t>();
+        safe_low.reset(num);
+        safe_high.set(num);
+    }
+
+    void SafeState::unregisterOutput(const GPIO &pin) noexcept
+    {
+        uint32_t num = pin.getNum().get_value<uint32_t>();
+        safe_high.reset(num);
+        safe_low.reset(num);
+    }
+
+    void IRAM_ATTR SafeState::apply() noexcept
+    {
+        GpioBanks::write(safe_high, safe_low);
+    }
+
+    void SafeState::installShutdownHandler()
+    {
+#if !CONFIG_IDF_TARGET_LINUX
+        GPIO_CHECK_THROW(esp_register_shutdown_handler(shutdownHandler));
+#else
+        (void)shutdownHandler;
+#endif
+    }
+
+    uint32_t SafeState::measureApply() noexcept
+    {
+        uint32_t start = GpioClock::cycles();
+        apply();
+        return GpioClock::cycles() - start;
+    }
+
+    GpioMask SafeState::getSafeHigh() noexcept
+    {
+        return safe_high;
+    }
+
+    GpioMask SafeState::getSafeLow() noexcept
+    {
+        return safe_low;
+    }
+
+}
+
+#endif
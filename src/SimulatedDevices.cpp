@@ -0,0 +1,793 @@
+#if __cpp_exceptions
+
+#include <cmath>
+#include <cstring>
+#include "SimulatedDevices.hpp"
+
+namespace Components
+{
+
+    namespace
+    {
+        constexpr uint64_t US = 1000;
+
+        constexpr uint8_t FLASH_WRITE_STATUS_BUSY = 1u << 0;
+        constexpr uint8_t FLASH_WRITE_ENABLE_LATCH = 1u << 1;
+
+        constexpr uint8_t FLASH_PAGE_PROGRAM = 0x02;
+        constexpr uint8_t FLASH_READ = 0x03;
+        constexpr uint8_t FLASH_WRITE_DISABLE = 0x04;
+        constexpr uint8_t FLASH_READ_STATUS = 0x05;
+        constexpr uint8_t FLASH_WRITE_ENABLE = 0x06;
+        constexpr uint8_t FLASH_SECTOR_ERASE = 0x20;
+        constexpr uint8_t FLASH_JEDEC_ID = 0x9F;
+        constexpr uint8_t FLASH_CHIP_ERASE = 0xC7;
+        constexpr size_t FLASH_PAGE_SIZE = 256;
+        constexpr size_t FLASH_SECTOR_SIZE = 4096;
+
+        constexpr uint8_t ONE_WIRE_READ_ROM = 0x33;
+        constexpr uint8_t ONE_WIRE_MATCH_ROM = 0x55;
+        constexpr uint8_t ONE_WIRE_SKIP_ROM = 0xCC;
+        constexpr uint8_t ONE_WIRE_SEARCH_ROM = 0xF0;
+        constexpr uint8_t ONE_WIRE_CONVERT_T = 0x44;
+        constexpr uint8_t ONE_WIRE_WRITE_SCRATCHPAD = 0x4E;
+        constexpr uint8_t ONE_WIRE_READ_SCRATCHPAD = 0xBE;
+
+        // a low phase this long is a reset, shorter ones are slots, which write 1 if shorter than the sample time
+        constexpr uint64_t ONE_WIRE_RESET_NS = 480 * US;
+        constexpr uint64_t ONE_WIRE_PRESENCE_WAIT_NS = 30 * US;
+        constexpr uint64_t ONE_WIRE_PRESENCE_NS = 120 * US;
+        constexpr uint64_t ONE_WIRE_SAMPLE_NS = 30 * US;
+        constexpr uint64_t ONE_WIRE_READ_HOLD_NS = 30 * US;
+        constexpr uint64_t ONE_WIRE_CONVERSION_NS = 750000 * US;
+    }
+
+    SimulatedShiftRegister::SimulatedShiftRegister(SimulatedNets &nets, size_t data, size_t clock, size_t latch,
+                                                   uint32_t bits)
+        : nets(nets),
+          data(data),
+          clock(clock),
+          latch(latch),
+          mask(bits >= 32 ? ~0u : (1u << bits) - 1),
+          shift(0),
+          outputs(0),
+          clock_count(0)
+    {
+        if (bits == 0 || bits > 32)
+        {
+            throw GPIOException(ESP_ERR_INVALID_ARG);
+        }
+
+        nets.addListener(clock, onEdge, this);
+        nets.addListener(latch, onEdge, this);
+    }
+
+    SimulatedShiftRegister::~SimulatedShiftRegister()
+    {
+        nets.removeListeners(this);
+    }
+
+    void SimulatedShiftRegister::onEdge(void *arg, size_t net, bool level, uint64_t time_ns) noexcept
+    {
+        (void)time_ns;
+        SimulatedShiftRegister &self = *static_cast<SimulatedShiftRegister *>(arg);
+        if (!level)
+        {
+            return;
+        }
+
+        if (net == self.clock)
+        {
+            self.shift = ((self.shift << 1) | self.nets.getLevel(self.data)) & self.mask;
+            self.clock_count++;
+        }
+        else
+        {
+            self.outputs = self.shift;
+        }
+    }
+
+    SimulatedI2cEeprom::SimulatedI2cEeprom(SimulatedNets &nets, size_t sda, size_t scl, uint8_t *memory, size_t size,
+                                           uint8_t address, size_t page_size, uint32_t write_time_us)
+        : nets(nets),
+          sda(sda),
+          scl(scl),
+          port(0),
+          memory(memory),
+          size(size),
+          page_size(page_size),
+          write_time_ns(write_time_us * US),
+          busy_until_ns(0),
+          pointer(0),
+          write_count(0),
+          address(address),
+          address_bytes(size > 256 ? 2 : 1),
+          byte_index(0),
+          bits(0),
+          shift(0),
+          phase(Phase::IDLE),
+          reading(false),
+          written(false),
+          master_nack(false)
+    {
+        if (!memory || size == 0 || page_size == 0 || (page_size & (page_size - 1)))
+        {
+            throw GPIOException(ESP_ERR_INVALID_ARG);
+        }
+
+        port = nets.addPort(sda);
+        nets.addListener(sda, onEdge, this);
+        nets.addListener(scl, onEdge, this);
+    }
+
+    SimulatedI2cEeprom::~SimulatedI2cEeprom()
+    {
+        nets.removeListeners(this);
+        nets.drive(port, NetDrive::RELEASED);
+    }
+
+    void SimulatedI2cEeprom::onEdge(void *arg, size_t net, bool level, uint64_t time_ns) noexcept
+    {
+        SimulatedI2cEeprom &self = *static_cast<SimulatedI2cEeprom *>(arg);
+        if (net == self.scl)
+        {
+            self.onClock(level, time_ns);
+            return;
+        }
+
+        // SDA changes while SCL is low are data, while SCL is high they are START and STOP conditions
+        if (!self.nets.getLevel(self.scl))
+        {
+            return;
+        }
+
+        self.nets.scheduleDrive(self.port, NetDrive::RELEASED, time_ns);
+        if (!level)
+        {
+            self.phase = Phase::RECEIVE;
+            self.byte_index = 0;
+            self.bits = 0;
+            self.shift = 0;
+            self.reading = false;
+            self.written = false;
+        }
+        else
+        {
+            if (self.written)
+            {
+                self.busy_until_ns = time_ns + self.write_time_ns;
+                self.write_count++;
+                self.written = false;
+            }
+            self.phase = Phase::IDLE;
+        }
+    }
+
+    void SimulatedI2cEeprom::onClock(bool level, uint64_t time_ns) noexcept
+    {
+        if (level)
+        {
+            if (phase == Phase::RECEIVE && bits < 8)
+            {
+                shift = static_cast<uint8_t>((shift << 1) | nets.getLevel(sda));
+                bits++;
+            }
+            else if (phase == Phase::MASTER_ACK)
+            {
+                master_nack = nets.getLevel(sda);
+            }
+            return;
+        }
+
+        switch (phase)
+        {
+        case Phase::RECEIVE:
+            if (bits == 8)
+            {
+                if (receiveByte(shift, time_ns))
+                {
+                    nets.scheduleDrive(port, NetDrive::LOW, time_ns);
+                    phase = Phase::ACK;
+                }
+                else
+                {
+                    phase = Phase::IDLE;
+                }
+            }
+            break;
+
+        case Phase::ACK:
+            bits = 0;
+            if (reading)
+            {
+                shift = memory[pointer];
+                pointer = (pointer + 1) % size;
+                phase = Phase::SEND;
+                sendBit(time_ns);
+            }
+            else
+            {
+                shift = 0;
+                phase = Phase::RECEIVE;
+                nets.scheduleDrive(port, NetDrive::RELEASED, time_ns);
+            }
+            break;
+
+        case Phase::SEND:
+            bits++;
+            if (bits == 8)
+            {
+                phase = Phase::MASTER_ACK;
+                nets.scheduleDrive(port, NetDrive::RELEASED, time_ns);
+            }
+            else
+            {
+                sendBit(time_ns);
+            }
+            break;
+
+        case Phase::MASTER_ACK:
+            if (master_nack)
+            {
+                phase = Phase::IDLE;
+            }
+            else
+            {
+                bits = 0;
+                shift = memory[pointer];
+                pointer = (pointer + 1) % size;
+                phase = Phase::SEND;
+                sendBit(time_ns);
+            }
+            break;
+
+        case Phase::IDLE:
+            break;
+        }
+    }
+
+    bool SimulatedI2cEeprom::receiveByte(uint8_t byte, uint64_t time_ns) noexcept
+    {
+        bits = 0;
+        if (byte_index == 0)
+        {
+            // busy with a write cycle, the address is not acknowledged
+            if ((byte >> 1) != address || time_ns < busy_until_ns)
+            {
+                return false;
+            }
+            reading = byte & 1;
+            byte_index++;
+            return true;
+        }
+
+        if (byte_index <= address_bytes)
+        {
+            pointer = (byte_index == 1 ? 0 : pointer << 8) | byte;
+            if (byte_index == address_bytes)
+            {
+                pointer %= size;
+            }
+            byte_index++;
+            return true;
+        }
+
+        memory[pointer] = byte;
+        pointer = ((pointer & ~(page_size - 1)) | ((pointer + 1) & (page_size - 1))) % size;
+        written = true;
+        return true;
+    }
+
+    void SimulatedI2cEeprom::sendBit(uint64_t time_ns) noexcept
+    {
+        bool high = shift & (0x80 >> bits);
+        nets.scheduleDrive(port, high ? NetDrive::RELEASED : NetDrive::LOW, time_ns);
+    }
+
+    SimulatedSpiFlash::SimulatedSpiFlash(SimulatedNets &nets, size_t cs, size_t sck, size_t mosi, size_t miso,
+                                         uint8_t *memory, size_t size, uint32_t jedec_id)
+        : nets(nets),
+          cs(cs),
+          sck(sck),
+          mosi(mosi),
+          port(0),
+          memory(memory),
+          size(size),
+          jedec_id(jedec_id),
+          busy_until_ns(0),
+          address(0),
+          command_count(0),
+          byte_index(0),
+          command(0),
+          bits(0),
+          rx(0),
+          tx(0),
+          selected(false),
+          output(false),
+          write_enable(false),
+          writable(false)
+    {
+        if (!memory || size == 0)
+        {
+            throw GPIOException(ESP_ERR_INVALID_ARG);
+        }
+
+        port = nets.addPort(miso);
+        nets.addListener(cs, onEdge, this);
+        nets.addListener(sck, onEdge, this);
+    }
+
+    SimulatedSpiFlash::~SimulatedSpiFlash()
+    {
+        nets.removeListeners(this);
+        nets.drive(port, NetDrive::RELEASED);
+    }
+
+    void SimulatedSpiFlash::onEdge(void *arg, size_t net, bool level, uint64_t time_ns) noexcept
+    {
+        SimulatedSpiFlash &self = *static_cast<SimulatedSpiFlash *>(arg);
+        if (net == self.cs)
+        {
+            if (level)
+            {
+                self.deselect(time_ns);
+            }
+            else
+            {
+                self.select(time_ns);
+            }
+            return;
+        }
+        if (!self.selected)
+        {
+            return;
+        }
+
+        if (level)
+        {
+            self.rx = static_cast<uint8_t>((self.rx << 1) | self.nets.getLevel(self.mosi));
+            if (++self.bits == 8)
+            {
+                self.bits = 0;
+                self.receiveByte(self.rx, time_ns);
+            }
+        }
+        else if (self.output)
+        {
+            self.nets.scheduleDrive(self.port, self.tx & 0x80 ? NetDrive::HIGH : NetDrive::LOW, time_ns);
+            self.tx = static_cast<uint8_t>(self.tx << 1);
+        }
+    }
+
+    void SimulatedSpiFlash::select(uint64_t time_ns) noexcept
+    {
+        (void)time_ns;
+        selected = true;
+        output = false;
+        byte_index = 0;
+        bits = 0;
+        rx = 0;
+    }
+
+    void SimulatedSpiFlash::deselect(uint64_t time_ns) noexcept
+    {
+        if (!selected)
+        {
+            return;
+        }
+        selected = false;
+        output = false;
+        nets.scheduleDrive(port, NetDrive::RELEASED, time_ns);
+        if (byte_index == 0)
+        {
+            return;
+        }
+        command_count++;
+
+        switch (command)
+        {
+        case FLASH_WRITE_ENABLE:
+            write_enable = true;
+            break;
+
+        case FLASH_WRITE_DISABLE:
+            write_enable = false;
+            break;
+
+        case FLASH_PAGE_PROGRAM:
+            if (writable && byte_index > 4)
+            {
+                busy_until_ns = time_ns + PAGE_PROGRAM_US * US;
+                write_enable = false;
+            }
+            break;
+
+        case FLASH_SECTOR_ERASE:
+            if (writable && byte_index >= 4)
+            {
+                size_t start = (address % size) & ~(FLASH_SECTOR_SIZE - 1);
+                size_t length = size - start < FLASH_SECTOR_SIZE ? size - start : FLASH_SECTOR_SIZE;
+                memset(memory + start, 0xFF, length);
+                busy_until_ns = time_ns + SECTOR_ERASE_US * US;
+                write_enable = false;
+            }
+            break;
+
+        case FLASH_CHIP_ERASE:
+            if (writable)
+            {
+                memset(memory, 0xFF, size);
+                busy_until_ns = time_ns + CHIP_ERASE_US * US;
+                write_enable = false;
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    void SimulatedSpiFlash::receiveByte(uint8_t byte, uint64_t time_ns) noexcept
+    {
+        uint32_t index = byte_index++;
+        if (index == 0)
+        {
+            bool busy = time_ns < busy_until_ns;
+            command = busy && byte != FLASH_READ_STATUS ? 0 : byte;
+            writable = write_enable && !busy;
+            if (command == FLASH_READ_STATUS)
+            {
+                output = true;
+                tx = status(time_ns);
+            }
+            else if (command == FLASH_JEDEC_ID)
+            {
+                output = true;
+                tx = static_cast<uint8_t>(jedec_id >> 16);
+            }
+            return;
+        }
+
+        // 24 bit address after the command byte
+        if (index <= 3 && (command == FLASH_READ || command == FLASH_PAGE_PROGRAM || command == FLASH_SECTOR_ERASE))
+        {
+            address = (index == 1 ? 0 : address << 8) | byte;
+            if (index == 3 && command == FLASH_READ)
+            {
+                address %= size;
+                output = true;
+                tx = memory[address];
+                address = (address + 1) % size;
+            }
+            return;
+        }
+
+        switch (command)
+        {
+        case FLASH_READ:
+            tx = memory[address];
+            address = (address + 1) % size;
+            break;
+
+        case FLASH_READ_STATUS:
+            tx = status(time_ns);
+            break;
+
+        case FLASH_JEDEC_ID:
+            tx = index < 3 ? static_cast<uint8_t>(jedec_id >> (16 - 8 * index)) : 0;
+            break;
+
+        case FLASH_PAGE_PROGRAM:
+            if (writable)
+            {
+                address %= size;
+                memory[address] &= byte;
+                address = (address & ~(FLASH_PAGE_SIZE - 1)) | ((address + 1) & (FLASH_PAGE_SIZE - 1));
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    uint8_t SimulatedSpiFlash::status(uint64_t time_ns) const noexcept
+    {
+        return (time_ns < busy_until_ns ? FLASH_WRITE_STATUS_BUSY : 0) | (write_enable ? FLASH_WRITE_ENABLE_LATCH : 0);
+    }
+
+    SimulatedOneWireSensor::SimulatedOneWireSensor(SimulatedNets &nets, size_t dq, uint64_t serial)
+        : nets(nets),
+          dq(dq),
+          port(0),
+          rom(),
+          scratchpad{0x50, 0x05, 0x4B, 0x46, 0x7F, 0xFF, 0x0C, 0x10, 0},
+          tx(),
+          temperature(25 * 16),
+          fall_ns(0),
+          busy_until_ns(0),
+          tx_size(0),
+          tx_bit(0),
+          search_bit(0),
+          search_step(0),
+          rx(0),
+          rx_bits(0),
+          rx_count(0),
+          stage(Stage::IDLE),
+          after_transmit(Stage::IDLE)
+    {
+        rom[0] = FAMILY_CODE;
+        for (size_t i = 1; i < 7; i++)
+        {
+            rom[i] = static_cast<uint8_t>(serial >> (8 * (i - 1)));
+        }
+        rom[7] = crc8(rom, 7);
+        scratchpad[8] = crc8(scratchpad, 8);
+
+        port = nets.addPort(dq);
+        nets.addListener(dq, onEdge, this);
+    }
+
+    SimulatedOneWireSensor::~SimulatedOneWireSensor()
+    {
+        nets.removeListeners(this);
+        nets.drive(port, NetDrive::RELEASED);
+    }
+
+    void SimulatedOneWireSensor::setTemperature(float celsius) noexcept
+    {
+        temperature = static_cast<int16_t>(std::lround(celsius * 16));
+    }
+
+    uint64_t SimulatedOneWireSensor::getRom() const noexcept
+    {
+        uint64_t code = 0;
+        for (size_t i = 0; i < 8; i++)
+        {
+            code |= static_cast<uint64_t>(rom[i]) << (8 * i);
+        }
+        return code;
+    }
+
+    uint8_t SimulatedOneWireSensor::crc8(const uint8_t *data, size_t size) noexcept
+    {
+        uint8_t crc = 0;
+        for (size_t i = 0; i < size; i++)
+        {
+            uint8_t byte = data[i];
+            for (int bit = 0; bit < 8; bit++)
+            {
+                bool mix = (crc ^ byte) & 1;
+                crc >>= 1;
+                if (mix)
+                {
+                    crc ^= 0x8C;
+                }
+                byte >>= 1;
+            }
+        }
+        return crc;
+    }
+
+    void SimulatedOneWireSensor::onEdge(void *arg, size_t net, bool level, uint64_t time_ns) noexcept
+    {
+        (void)net;
+        SimulatedOneWireSensor &self = *static_cast<SimulatedOneWireSensor *>(arg);
+        bool bit;
+
+        if (!level)
+        {
+            if (self.stage == Stage::PRESENCE)
+            {
+                return;
+            }
+            self.fall_ns = time_ns;
+            // a 0 is sent by holding the slot the master started low
+            if (self.transmitBit(bit, time_ns) && !bit)
+            {
+                self.nets.scheduleDrive(self.port, NetDrive::LOW, time_ns, time_ns + ONE_WIRE_READ_HOLD_NS);
+            }
+            return;
+        }
+
+        if (self.stage == Stage::PRESENCE)
+        {
+            self.stage = Stage::ROM_COMMAND;
+            self.rx = 0;
+            self.rx_bits = 0;
+            return;
+        }
+
+        uint64_t low_ns = time_ns - self.fall_ns;
+        if (low_ns >= ONE_WIRE_RESET_NS)
+        {
+            self.stage = Stage::PRESENCE;
+            uint64_t start = time_ns + ONE_WIRE_PRESENCE_WAIT_NS;
+            self.nets.scheduleDrive(self.port, NetDrive::LOW, start, start + ONE_WIRE_PRESENCE_NS);
+        }
+        else if (self.transmitBit(bit, time_ns))
+        {
+            self.endTransmitSlot();
+        }
+        else
+        {
+            self.receiveBit(low_ns < ONE_WIRE_SAMPLE_NS, time_ns);
+        }
+    }
+
+    bool SimulatedOneWireSensor::transmitBit(bool &bit, uint64_t time_ns) const noexcept
+    {
+        switch (stage)
+        {
+        case Stage::READ_ROM:
+        case Stage::READ_SCRATCHPAD:
+            bit = (tx[tx_bit / 8] >> (tx_bit % 8)) & 1;
+            return true;
+
+        case Stage::CONVERTING:
+            bit = time_ns >= busy_until_ns;
+            return true;
+
+        case Stage::SEARCH_ROM:
+            if (search_step == 2)
+            {
+                return false;
+            }
+            bit = ((rom[search_bit / 8] >> (search_bit % 8)) & 1) != search_step;
+            return true;
+
+        default:
+            return false;
+        }
+    }
+
+    void SimulatedOneWireSensor::endTransmitSlot() noexcept
+    {
+        if (stage == Stage::SEARCH_ROM)
+        {
+            search_step++;
+        }
+        else if (stage != Stage::CONVERTING && ++tx_bit == tx_size * 8)
+        {
+            stage = after_transmit;
+            rx = 0;
+            rx_bits = 0;
+        }
+    }
+
+    void SimulatedOneWireSensor::receiveBit(bool bit, uint64_t time_ns) noexcept
+    {
+        switch (stage)
+        {
+        case Stage::SEARCH_ROM:
+            // the direction chosen by the master, devices with the other bit drop out until the next reset
+            if (bit != ((rom[search_bit / 8] >> (search_bit % 8)) & 1))
+            {
+                stage = Stage::IDLE;
+            }
+            else if (++search_bit == 64)
+            {
+                stage = Stage::FUNCTION_COMMAND;
+                rx = 0;
+                rx_bits = 0;
+            }
+            else
+            {
+                search_step = 0;
+            }
+            break;
+
+        case Stage::ROM_COMMAND:
+        case Stage::MATCH_ROM:
+        case Stage::FUNCTION_COMMAND:
+        case Stage::WRITE_SCRATCHPAD:
+            rx |= static_cast<uint8_t>(bit << rx_bits);
+            if (++rx_bits == 8)
+            {
+                uint8_t byte = rx;
+                rx = 0;
+                rx_bits = 0;
+                receiveByte(byte, time_ns);
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    void SimulatedOneWireSensor::receiveByte(uint8_t byte, uint64_t time_ns) noexcept
+    {
+        switch (stage)
+        {
+        case Stage::ROM_COMMAND:
+            if (byte == ONE_WIRE_READ_ROM)
+            {
+                startTransmit(rom, sizeof(rom), Stage::READ_ROM, Stage::FUNCTION_COMMAND);
+            }
+            else if (byte == ONE_WIRE_SKIP_ROM)
+            {
+                stage = Stage::FUNCTION_COMMAND;
+            }
+            else if (byte == ONE_WIRE_MATCH_ROM)
+            {
+                stage = Stage::MATCH_ROM;
+                rx_count = 0;
+            }
+            else if (byte == ONE_WIRE_SEARCH_ROM)
+            {
+                stage = Stage::SEARCH_ROM;
+                search_bit = 0;
+                search_step = 0;
+            }
+            else
+            {
+                stage = Stage::IDLE;
+            }
+            break;
+
+        case Stage::MATCH_ROM:
+            if (byte != rom[rx_count])
+            {
+                stage = Stage::IDLE;
+            }
+            else if (++rx_count == sizeof(rom))
+            {
+                stage = Stage::FUNCTION_COMMAND;
+            }
+            break;
+
+        case Stage::FUNCTION_COMMAND:
+            if (byte == ONE_WIRE_CONVERT_T)
+            {
+                // 12 bit resolution by default, every bit less halves the conversion time
+                uint32_t unused_bits = 3 - ((scratchpad[4] >> 5) & 3);
+                int16_t value = static_cast<int16_t>(temperature & ~((1 << unused_bits) - 1));
+                scratchpad[0] = static_cast<uint8_t>(value);
+                scratchpad[1] = static_cast<uint8_t>(static_cast<uint16_t>(value) >> 8);
+                scratchpad[8] = crc8(scratchpad, 8);
+                busy_until_ns = time_ns + (ONE_WIRE_CONVERSION_NS >> unused_bits);
+                stage = Stage::CONVERTING;
+            }
+            else if (byte == ONE_WIRE_READ_SCRATCHPAD)
+            {
+                startTransmit(scratchpad, sizeof(scratchpad), Stage::READ_SCRATCHPAD, Stage::IDLE);
+            }
+            else if (byte == ONE_WIRE_WRITE_SCRATCHPAD)
+            {
+                stage = Stage::WRITE_SCRATCHPAD;
+                rx_count = 0;
+            }
+            else
+            {
+                stage = Stage::IDLE;
+            }
+            break;
+
+        case Stage::WRITE_SCRATCHPAD:
+            // TH, TL and the configuration register, of which only the resolution bits are writable
+            scratchpad[2 + rx_count] = rx_count == 2 ? static_cast<uint8_t>((byte & 0x60) | 0x1F) : byte;
+            if (++rx_count == 3)
+            {
+                scratchpad[8] = crc8(scratchpad, 8);
+                stage = Stage::IDLE;
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    void SimulatedOneWireSensor::startTransmit(const uint8_t *data, size_t size, Stage transmit, Stage next) noexcept
+    {
+        memcpy(tx, data, size);
+        tx_size = static_cast<uint32_t>(size);
+        tx_bit = 0;
+        stage = transmit;
+        after_transmit = next;
+    }
+
+}
+
+#endif
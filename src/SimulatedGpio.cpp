@@ -0,0 +1,217 @@
+#if __cpp_exceptions
+
+#include "SimulatedGpio.hpp"
+#include "GpioClock.hpp"
+#include "SimulatedNets.hpp"
+
+namespace Components
+{
+
+    namespace
+    {
+        /*
+         * Like the hardware registers, every register is an independent location. Set and clear are single atomic
+         * read-modify-writes, so threads writing different pins of a bank never lose each other's stores.
+         */
+        constexpr std::memory_order ORDER = std::memory_order_relaxed;
+    }
+
+    SimulatedGpioRegisters::SimulatedGpioRegisters() noexcept : nets(nullptr), tracing(false)
+    {
+        reset();
+    }
+
+    SimulatedGpioRegisters &SimulatedGpioRegisters::instance() noexcept
+    {
+        static SimulatedGpioRegisters registers;
+        return registers;
+    }
+
+    void SimulatedGpioRegisters::write(size_t bank, uint32_t set, uint32_t clear) noexcept
+    {
+        if (set)
+        {
+            uint32_t before = output[bank].fetch_or(set, ORDER);
+            store_count.fetch_add(1, ORDER);
+            trace(bank, before, before | set);
+            notify(bank, ~before & set);
+        }
+        if (clear)
+        {
+            uint32_t before = output[bank].fetch_and(~clear, ORDER);
+            store_count.fetch_add(1, ORDER);
+            trace(bank, before, before & ~clear);
+            notify(bank, before & clear);
+        }
+    }
+
+    void SimulatedGpioRegisters::writeOutput(size_t bank, uint32_t value) noexcept
+    {
+        uint32_t before = output[bank].exchange(value, ORDER);
+        store_count.fetch_add(1, ORDER);
+        trace(bank, before, value);
+        notify(bank, before ^ value);
+    }
+
+    uint32_t SimulatedGpioRegisters::readOutput(size_t bank) const noexcept
+    {
+        return output[bank].load(ORDER);
+    }
+
+    uint32_t SimulatedGpioRegisters::readInput(size_t bank) const noexcept
+    {
+        uint32_t enable = output_enable[bank].load(ORDER);
+        uint32_t value = (output[bank].load(ORDER) & enable) | (external[bank].load(ORDER) & ~enable);
+        if (nets)
+        {
+            uint32_t connected;
+            uint32_t levels = nets->readBank(bank, connected);
+            value = (value & ~connected) | (levels & connected);
+        }
+        return value;
+    }
+
+    void SimulatedGpioRegisters::setOutputEnable(size_t bank, uint32_t mask) noexcept
+    {
+        uint32_t before = output_enable[bank].exchange(mask, ORDER);
+        notify(bank, before ^ mask);
+    }
+
+    void SimulatedGpioRegisters::writeOutputEnable(size_t bank, uint32_t set, uint32_t clear) noexcept
+    {
+        uint32_t before = output_enable[bank].fetch_or(set, ORDER);
+        uint32_t changed = ~before & set;
+        before = output_enable[bank].fetch_and(~clear, ORDER);
+        notify(bank, changed | (before & clear));
+    }
+
+    uint32_t SimulatedGpioRegisters::getOutputEnable(size_t bank) const noexcept
+    {
+        return output_enable[bank].load(ORDER);
+    }
+
+    void SimulatedGpioRegisters::setOpenDrain(uint32_t pin, bool enable) noexcept
+    {
+        size_t bank = pin / GpioMask::BANK_BITS;
+        uint32_t bit = 1u << (pin % GpioMask::BANK_BITS);
+        uint32_t before = enable ? open_drain[bank].fetch_or(bit, ORDER) : open_drain[bank].fetch_and(~bit, ORDER);
+        if (((before & bit) != 0) != enable)
+        {
+            notify(bank, bit);
+        }
+    }
+
+    uint32_t SimulatedGpioRegisters::getOpenDrain(size_t bank) const noexcept
+    {
+        return open_drain[bank].load(ORDER);
+    }
+
+    void SimulatedGpioRegisters::setPull(uint32_t pin, bool up, bool down) noexcept
+    {
+        size_t bank = pin / GpioMask::BANK_BITS;
+        uint32_t bit = 1u << (pin % GpioMask::BANK_BITS);
+        if (up)
+        {
+            pull_up[bank].fetch_or(bit, ORDER);
+        }
+        else
+        {
+            pull_up[bank].fetch_and(~bit, ORDER);
+        }
+        if (down)
+        {
+            pull_down[bank].fetch_or(bit, ORDER);
+        }
+        else
+        {
+            pull_down[bank].fetch_and(~bit, ORDER);
+        }
+        notify(bank, bit);
+    }
+
+    uint32_t SimulatedGpioRegisters::getPullUp(size_t bank) const noexcept
+    {
+        return pull_up[bank].load(ORDER);
+    }
+
+    uint32_t SimulatedGpioRegisters::getPullDown(size_t bank) const noexcept
+    {
+        return pull_down[bank].load(ORDER);
+    }
+
+    void SimulatedGpioRegisters::setExternal(uint32_t pin, bool level) noexcept
+    {
+        uint32_t bit = 1u << (pin % GpioMask::BANK_BITS);
+        if (level)
+        {
+            external[pin / GpioMask::BANK_BITS].fetch_or(bit, ORDER);
+        }
+        else
+        {
+            external[pin / GpioMask::BANK_BITS].fetch_and(~bit, ORDER);
+        }
+    }
+
+    void SimulatedGpioRegisters::attachNets(SimulatedNets *attached) noexcept
+    {
+        nets = attached;
+    }
+
+    void SimulatedGpioRegisters::reset() noexcept
+    {
+        for (size_t bank = 0; bank < BANK_COUNT; bank++)
+        {
+            output[bank].store(0, ORDER);
+            output_enable[bank].store(0, ORDER);
+            open_drain[bank].store(0, ORDER);
+            pull_up[bank].store(0, ORDER);
+            pull_down[bank].store(0, ORDER);
+            external[bank].store(0, ORDER);
+            notify(bank, ~0u);
+        }
+        store_count.store(0, ORDER);
+        trace_count.store(0, ORDER);
+    }
+
+    void SimulatedGpioRegisters::setTracing(bool enable) noexcept
+    {
+        trace_count.store(0, ORDER);
+        tracing.store(enable, ORDER);
+    }
+
+    size_t SimulatedGpioRegisters::readTrace(StoreRecord *records, size_t max_records) noexcept
+    {
+        // stores after the trace filled up still claimed an index
+        size_t traced = trace_count.exchange(0, ORDER);
+        traced = traced < TRACE_SIZE ? traced : TRACE_SIZE;
+        size_t copied = traced < max_records ? traced : max_records;
+        for (size_t i = 0; i < copied; i++)
+        {
+            records[i] = trace_records[i];
+        }
+        return copied;
+    }
+
+    void SimulatedGpioRegisters::trace(size_t bank, uint32_t before, uint32_t after) noexcept
+    {
+        if (tracing.load(ORDER))
+        {
+            size_t index = trace_count.fetch_add(1, ORDER);
+            if (index < TRACE_SIZE)
+            {
+                trace_records[index] = StoreRecord{GpioClock::cycles(), static_cast<uint32_t>(bank), before ^ after};
+            }
+        }
+    }
+
+    void SimulatedGpioRegisters::notify(size_t bank, uint32_t changed) noexcept
+    {
+        if (nets && changed)
+        {
+            nets->updatePins(bank, changed);
+        }
+    }
+
+}
+
+#endif
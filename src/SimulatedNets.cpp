@@ -0,0 +1,422 @@
+#if __cpp_exceptions
+
+#include "SimulatedNets.hpp"
+#include "GpioClock.hpp"
+
+namespace Components
+{
+
+    namespace
+    {
+        constexpr uint32_t conductance(uint32_t ohms) noexcept
+        {
+            return 1000000000u / ohms;
+        }
+
+        constexpr uint32_t INTERNAL_PULL = conductance(SimulatedNets::INTERNAL_PULL_OHMS);
+
+        /*
+         * 0.69 * R * C in nanoseconds, with C in picofarad and the conductance 1 / R in nanosiemens.
+         */
+        uint64_t riseNs(uint32_t capacitance_pf, uint64_t conductance_ns) noexcept
+        {
+            return conductance_ns ? 693000ull * capacitance_pf / conductance_ns : 0;
+        }
+
+        static_assert(SimulatedNets::MAX_NETS <= 32 && SimulatedNets::MAX_PORTS <= 64, "pending events are bit masks");
+
+        uint64_t nowNs() noexcept
+        {
+#if CONFIG_IDF_TARGET_LINUX
+            return GpioClock::nowNs();
+#else
+            return static_cast<uint64_t>(GpioClock::nowUs()) * 1000;
+#endif
+        }
+    }
+
+    SimulatedNets::SimulatedNets(SimulatedGpioRegisters &registers) noexcept
+        : registers(registers),
+          nets(),
+          net_count(0),
+          ports(),
+          port_count(0),
+          pin_contributions(),
+          connected_pins(),
+          listeners(),
+          listener_count(0),
+          pending_nets(0),
+          scheduled_ports(0),
+          polling(false)
+    {
+        pin_nets.fill(-1);
+        registers.attachNets(this);
+    }
+
+    SimulatedNets::~SimulatedNets()
+    {
+        if (registers.getNets() == this)
+        {
+            registers.attachNets(nullptr);
+        }
+    }
+
+    size_t SimulatedNets::addNet(uint32_t capacitance_pf)
+    {
+        if (net_count == MAX_NETS)
+        {
+            throw GPIOException(ESP_ERR_NO_MEM);
+        }
+
+        nets[net_count] = Net{};
+        nets[net_count].capacitance_pf = capacitance_pf;
+        return net_count++;
+    }
+
+    void SimulatedNets::connectPin(size_t net, uint32_t pin)
+    {
+        if (net >= net_count || isValidPin(pin) != ESP_OK || pin_nets[pin] >= 0)
+        {
+            throw GPIOException(ESP_ERR_INVALID_ARG);
+        }
+
+        pin_nets[pin] = static_cast<int8_t>(net);
+        connected_pins[pin / GpioMask::BANK_BITS] |= 1u << (pin % GpioMask::BANK_BITS);
+        pin_contributions[pin] = Contribution{NetDrive::RELEASED, 0, 0};
+        updatePins(pin / GpioMask::BANK_BITS, 1u << (pin % GpioMask::BANK_BITS));
+    }
+
+    void SimulatedNets::addPull(size_t net, uint32_t ohms, bool up)
+    {
+        if (net >= net_count || ohms == 0)
+        {
+            throw GPIOException(ESP_ERR_INVALID_ARG);
+        }
+
+        poll();
+        Contribution pull{NetDrive::RELEASED, up ? conductance(ohms) : 0, up ? 0 : conductance(ohms)};
+        apply(net, Contribution{NetDrive::RELEASED, 0, 0}, pull, nowNs());
+    }
+
+    size_t SimulatedNets::addPort(size_t net)
+    {
+        if (net >= net_count)
+        {
+            throw GPIOException(ESP_ERR_INVALID_ARG);
+        }
+        if (port_count == MAX_PORTS)
+        {
+            throw GPIOException(ESP_ERR_NO_MEM);
+        }
+
+        ports[port_count] = Port{static_cast<uint8_t>(net), NetDrive::RELEASED, NetDrive::RELEASED, 0, 0};
+        return port_count++;
+    }
+
+    void SimulatedNets::addListener(size_t net, Listener listener, void *arg)
+    {
+        if (net >= net_count || !listener)
+        {
+            throw GPIOException(ESP_ERR_INVALID_ARG);
+        }
+        if (listener_count == MAX_LISTENERS)
+        {
+            throw GPIOException(ESP_ERR_NO_MEM);
+        }
+
+        listeners[listener_count++] = ListenerSlot{net, listener, arg};
+    }
+
+    void SimulatedNets::removeListeners(void *arg) noexcept
+    {
+        size_t kept = 0;
+        for (size_t i = 0; i < listener_count; i++)
+        {
+            if (listeners[i].arg != arg)
+            {
+                listeners[kept++] = listeners[i];
+            }
+        }
+        listener_count = kept;
+    }
+
+    void SimulatedNets::drive(size_t port, NetDrive drive) noexcept
+    {
+        poll();
+        scheduled_ports &= ~(1ull << port);
+        driveAt(port, drive, nowNs());
+    }
+
+    void SimulatedNets::scheduleDrive(size_t port, NetDrive drive, uint64_t time_ns, uint64_t release_ns) noexcept
+    {
+        ports[port].scheduled_drive = drive;
+        ports[port].scheduled_ns = time_ns;
+        ports[port].release_ns = release_ns;
+        scheduled_ports |= 1ull << port;
+        poll();
+    }
+
+    void SimulatedNets::poll() noexcept
+    {
+        if (polling || (!pending_nets && !scheduled_ports))
+        {
+            return;
+        }
+
+        polling = true;
+        uint64_t now = nowNs();
+        while (true)
+        {
+            // the earliest due event, an edge of a net or a scheduled drive of a port
+            uint64_t first = now + 1;
+            int net = -1;
+            int port = -1;
+            for (uint32_t pending = pending_nets; pending; pending &= pending - 1)
+            {
+                int candidate = __builtin_ctz(pending);
+                if (nets[candidate].settle_ns < first)
+                {
+                    first = nets[candidate].settle_ns;
+                    net = candidate;
+                }
+            }
+            for (uint64_t scheduled = scheduled_ports; scheduled; scheduled &= scheduled - 1)
+            {
+                int candidate = __builtin_ctzll(scheduled);
+                if (ports[candidate].scheduled_ns < first)
+                {
+                    first = ports[candidate].scheduled_ns;
+                    port = candidate;
+                    net = -1;
+                }
+            }
+
+            if (port >= 0)
+            {
+                Port &target = ports[port];
+                NetDrive drive = target.scheduled_drive;
+                if (target.release_ns)
+                {
+                    target.scheduled_drive = NetDrive::RELEASED;
+                    target.scheduled_ns = target.release_ns;
+                    target.release_ns = 0;
+                }
+                else
+                {
+                    scheduled_ports &= ~(1ull << port);
+                }
+                driveAt(static_cast<size_t>(port), drive, first);
+            }
+            else if (net >= 0)
+            {
+                pending_nets &= ~(1u << net);
+                setLevel(static_cast<size_t>(net), nets[net].target, first);
+            }
+            else
+            {
+                break;
+            }
+        }
+        polling = false;
+    }
+
+    bool SimulatedNets::getLevel(size_t net) noexcept
+    {
+        poll();
+        return nets[net].level;
+    }
+
+    bool SimulatedNets::getPortLevel(size_t port) noexcept
+    {
+        return getLevel(ports[port].net);
+    }
+
+    uint64_t SimulatedNets::settlingNs(size_t net) noexcept
+    {
+        poll();
+        return pending_nets & (1u << net) ? nets[net].settle_ns - nowNs() : 0;
+    }
+
+    bool SimulatedNets::isContended(size_t net) const noexcept
+    {
+        return nets[net].contended;
+    }
+
+    bool SimulatedNets::isFloating(size_t net) const noexcept
+    {
+        const Net &state = nets[net];
+        return !state.drive_high && !state.drive_low && !state.pull_up && !state.pull_down;
+    }
+
+    uint32_t SimulatedNets::getContentions(size_t net) const noexcept
+    {
+        return nets[net].contentions;
+    }
+
+    uint32_t SimulatedNets::getTotalContentions() const noexcept
+    {
+        uint32_t total = 0;
+        for (size_t net = 0; net < net_count; net++)
+        {
+            total += nets[net].contentions;
+        }
+        return total;
+    }
+
+    void SimulatedNets::updatePins(size_t bank, uint32_t pins) noexcept
+    {
+        pins &= connected_pins[bank];
+        if (!pins)
+        {
+            return;
+        }
+
+        poll();
+        uint64_t now = nowNs();
+        while (pins)
+        {
+            uint32_t pin = bank * GpioMask::BANK_BITS + __builtin_ctz(pins);
+            pins &= pins - 1;
+
+            Contribution after = pinContribution(pin);
+            apply(static_cast<size_t>(pin_nets[pin]), pin_contributions[pin], after, now);
+            pin_contributions[pin] = after;
+        }
+    }
+
+    uint32_t SimulatedNets::readBank(size_t bank, uint32_t &connected) noexcept
+    {
+        connected = connected_pins[bank];
+        poll();
+
+        uint32_t levels = 0;
+        for (uint32_t pins = connected; pins; pins &= pins - 1)
+        {
+            uint32_t bit = __builtin_ctz(pins);
+            if (nets[pin_nets[bank * GpioMask::BANK_BITS + bit]].level)
+            {
+                levels |= 1u << bit;
+            }
+        }
+        return levels;
+    }
+
+    SimulatedNets::Contribution SimulatedNets::pinContribution(uint32_t pin) const noexcept
+    {
+        size_t bank = pin / GpioMask::BANK_BITS;
+        uint32_t bit = 1u << (pin % GpioMask::BANK_BITS);
+
+        Contribution contribution{NetDrive::RELEASED, 0, 0};
+        if (registers.getOutputEnable(bank) & bit)
+        {
+            if (!(registers.readOutput(bank) & bit))
+            {
+                contribution.drive = NetDrive::LOW;
+            }
+            else if (!(registers.getOpenDrain(bank) & bit))
+            {
+                contribution.drive = NetDrive::HIGH;
+            }
+        }
+        if (registers.getPullUp(bank) & bit)
+        {
+            contribution.pull_up = INTERNAL_PULL;
+        }
+        if (registers.getPullDown(bank) & bit)
+        {
+            contribution.pull_down = INTERNAL_PULL;
+        }
+        return contribution;
+    }
+
+    void SimulatedNets::apply(size_t net, const Contribution &before, const Contribution &after, uint64_t now) noexcept
+    {
+        Net &state = nets[net];
+        state.drive_high += (after.drive == NetDrive::HIGH) - (before.drive == NetDrive::HIGH);
+        state.drive_low += (after.drive == NetDrive::LOW) - (before.drive == NetDrive::LOW);
+        state.pull_up += after.pull_up - before.pull_up;
+        state.pull_down += after.pull_down - before.pull_down;
+        resolve(net, now);
+    }
+
+    void SimulatedNets::driveAt(size_t port, NetDrive drive, uint64_t now) noexcept
+    {
+        Port &target = ports[port];
+        if (target.drive != drive)
+        {
+            NetDrive before = target.drive;
+            target.drive = drive;
+            apply(target.net, Contribution{before, 0, 0}, Contribution{drive, 0, 0}, now);
+        }
+    }
+
+    void SimulatedNets::setLevel(size_t net, bool level, uint64_t now) noexcept
+    {
+        if (nets[net].level == level)
+        {
+            return;
+        }
+
+        nets[net].level = level;
+        for (size_t i = 0; i < listener_count; i++)
+        {
+            if (listeners[i].net == net)
+            {
+                listeners[i].listener(listeners[i].arg, net, level, now);
+            }
+        }
+    }
+
+    void SimulatedNets::resolve(size_t index, uint64_t now) noexcept
+    {
+        Net &net = nets[index];
+        bool contended = net.drive_high && net.drive_low;
+        if (contended && !net.contended)
+        {
+            net.contentions++;
+        }
+        net.contended = contended;
+
+        bool target = net.level;
+        uint64_t strength = 0;
+        if (contended)
+        {
+            // the level is undefined, keep it
+        }
+        else if (net.drive_high || net.drive_low)
+        {
+            // driven edges take a few nanoseconds, they are visible right away
+            pending_nets &= ~(1u << index);
+            net.target = net.drive_high != 0;
+            setLevel(index, net.target, now);
+            return;
+        }
+        else if (net.pull_up != net.pull_down)
+        {
+            target = net.pull_up > net.pull_down;
+            strength = static_cast<uint64_t>(net.pull_up) + net.pull_down;
+        }
+
+        // an edge already on its way is not restarted by other changes of the net, a stronger pull speeds it up
+        uint64_t settle_ns = now + riseNs(net.capacitance_pf, strength);
+        bool pending = pending_nets & (1u << index);
+        if (target != net.target || !pending || settle_ns < net.settle_ns)
+        {
+            net.target = target;
+            net.settle_ns = settle_ns;
+        }
+
+        if (net.target != net.level)
+        {
+            pending_nets |= 1u << index;
+            poll();
+        }
+        else
+        {
+            pending_nets &= ~(1u << index);
+        }
+    }
+
+}
+
+#endif
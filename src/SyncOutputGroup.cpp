@@ -0,0 +1,207 @@
+#if __cpp_exceptions
+
+#if CONFIG_IDF_TARGET_LINUX
+#include <mutex>
+#include "SimulatedGpio.hpp"
+#else
+#include "freertos/FreeRTOS.h"
+#endif
+#include "SyncOutputGroup.hpp"
+#include "GpioBanks.hpp"
+#include "GpioClock.hpp"
+
+namespace Components
+{
+
+    namespace
+    {
+#if CONFIG_IDF_TARGET_LINUX
+        std::mutex output_lock;
+#else
+        portMUX_TYPE output_lock = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
+        void lockOutputs() noexcept
+        {
+#if CONFIG_IDF_TARGET_LINUX
+            output_lock.lock();
+#else
+            portENTER_CRITICAL_SAFE(&output_lock);
+#endif
+        }
+
+        void unlockOutputs() noexcept
+        {
+#if CONFIG_IDF_TARGET_LINUX
+            output_lock.unlock();
+#else
+            portEXIT_CRITICAL_SAFE(&output_lock);
+#endif
+        }
+
+        /*
+         * Collects the first and last timestamp of a series of stores. On Linux the stores are taken from the trace
+         * of the simulated registers afterwards, so nothing is stamped here.
+         */
+        struct SkewStamps
+        {
+            uint32_t first = 0;
+            uint32_t last = 0;
+            uint32_t stores = 0;
+
+            void stamp() noexcept
+            {
+#if !CONFIG_IDF_TARGET_LINUX
+                uint32_t now = GpioClock::cycles();
+                if (stores++ == 0)
+                {
+                    first = now;
+                }
+                last = now;
+#endif
+            }
+        };
+    }
+
+    SyncOutputGroup::SyncOutputGroup(std::initializer_list<std::reference_wrapper<PinOutput>> pins)
+        : pins(), nums(), count(pins.size()), mask()
+    {
+        if (count == 0 || count > MAX_PINS)
+        {
+            throw GPIOException(ESP_ERR_INVALID_ARG);
+        }
+
+        size_t i = 0;
+        for (PinOutput &pin : pins)
+        {
+            uint32_t num = pin.getNum().get_value<uint32_t>();
+            this->pins[i] = &pin;
+            nums[i] = static_cast<uint8_t>(num);
+            mask.set(num);
+            i++;
+        }
+    }
+
+    GpioMask SyncOutputGroup::levelMask(uint32_t levels) const noexcept
+    {
+        GpioMask high;
+        for (size_t i = 0; i < count; i++)
+        {
+            if (levels & (1u << i))
+            {
+                high.set(nums[i]);
+            }
+        }
+        return high;
+    }
+
+    void SyncOutputGroup::write(uint32_t levels) noexcept
+    {
+        GpioBanks::assign(mask, levelMask(levels));
+    }
+
+    void SyncOutputGroup::writeSynchronous(uint32_t levels) noexcept
+    {
+        GpioMask high = levelMask(levels);
+        lockOutputs();
+        for (size_t bank = 0; bank < GpioBanks::BANK_COUNT; bank++)
+        {
+            if (mask.banks[bank])
+            {
+                GpioBanks::assignBank(bank, mask.banks[bank], high.banks[bank]);
+            }
+        }
+        unlockOutputs();
+    }
+
+    void SyncOutputGroup::setAllHigh() noexcept
+    {
+        GpioBanks::setHigh(mask);
+    }
+
+    void SyncOutputGroup::setAllLow() noexcept
+    {
+        GpioBanks::setLow(mask);
+    }
+
+    OutputSkew SyncOutputGroup::measureSkew(uint32_t levels, SyncWriteMode mode)
+    {
+        GpioMask high = levelMask(levels);
+        GpioMask low = mask - high;
+        SkewStamps stamps;
+
+#if CONFIG_IDF_TARGET_LINUX
+        SimulatedGpioRegisters &registers = SimulatedGpioRegisters::instance();
+        registers.setTracing(true);
+#endif
+
+        switch (mode)
+        {
+        case SyncWriteMode::INDIVIDUAL:
+            for (size_t i = 0; i < count; i++)
+            {
+                if (levels & (1u << i))
+                {
+                    pins[i]->setHigh();
+                }
+                else
+                {
+                    pins[i]->setLow();
+                }
+                stamps.stamp();
+            }
+            break;
+
+        case SyncWriteMode::GROUPED:
+            for (size_t bank = 0; bank < GpioBanks::BANK_COUNT; bank++)
+            {
+                if (high.banks[bank])
+                {
+                    GpioBanks::writeBank(bank, high.banks[bank], 0);
+                    stamps.stamp();
+                }
+                if (low.banks[bank])
+                {
+                    GpioBanks::writeBank(bank, 0, low.banks[bank]);
+                    stamps.stamp();
+                }
+            }
+            break;
+
+        case SyncWriteMode::SYNCHRONOUS:
+            lockOutputs();
+            for (size_t bank = 0; bank < GpioBanks::BANK_COUNT; bank++)
+            {
+                if (mask.banks[bank])
+                {
+                    GpioBanks::assignBank(bank, mask.banks[bank], high.banks[bank]);
+                    stamps.stamp();
+                }
+            }
+            unlockOutputs();
+            break;
+        }
+
+#if CONFIG_IDF_TARGET_LINUX
+        std::array<SimulatedGpioRegisters::StoreRecord, SimulatedGpioRegisters::TRACE_SIZE> records;
+        size_t traced = registers.readTrace(records.data(), records.size());
+        registers.setTracing(false);
+        for (size_t i = 0; i < traced; i++)
+        {
+            if (records[i].changed & mask.banks[records[i].bank])
+            {
+                if (stamps.stores++ == 0)
+                {
+                    stamps.first = records[i].time;
+                }
+                stamps.last = records[i].time;
+            }
+        }
+#endif
+
+        return OutputSkew{stamps.last - stamps.first, stamps.stores};
+    }
+
+}
+
+#endif